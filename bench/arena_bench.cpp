@@ -0,0 +1,76 @@
+/*
+ * arena_bench.cpp
+ *
+ * Per request callbacks with captures too large for a small buffer: 16 are
+ * created, called once and freed per request. Stored in a delegate_arena
+ * reset at request end, compared with std::function allocating each.
+ */
+
+#include "delegate/arena_delegate.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <functional>
+
+namespace
+{
+
+constexpr int kCallbacks = 16;
+
+struct Context
+{
+    long id;
+    long values[7];
+};
+
+void
+BM_arena_delegate(benchmark::State& state)
+{
+    alignas(std::max_align_t) static unsigned char buf[kCallbacks * 128];
+    delegate_arena arena(buf);
+    delegate<long(long)> cbs[kCallbacks];
+    Context ctx{};
+    for (auto _ : state)
+    {
+        for (int i = 0; i < kCallbacks; ++i)
+        {
+            ctx.id = i;
+            cbs[i] = arena_delegate<long(long)>(
+                arena, [ctx](long x) { return x + ctx.id + ctx.values[3]; });
+        }
+        long sum = 0;
+        for (auto& cb : cbs)
+            sum += cb(1);
+        benchmark::DoNotOptimize(sum);
+        arena.reset();
+    }
+    state.SetItemsProcessed(state.iterations() * kCallbacks);
+}
+
+void
+BM_std_function_heap(benchmark::State& state)
+{
+    std::function<long(long)> cbs[kCallbacks];
+    Context ctx{};
+    for (auto _ : state)
+    {
+        for (int i = 0; i < kCallbacks; ++i)
+        {
+            ctx.id = i;
+            cbs[i] = [ctx](long x) { return x + ctx.id + ctx.values[3]; };
+        }
+        long sum = 0;
+        for (auto& cb : cbs)
+            sum += cb(1);
+        benchmark::DoNotOptimize(sum);
+        for (auto& cb : cbs)
+            cb = nullptr;
+    }
+    state.SetItemsProcessed(state.iterations() * kCallbacks);
+}
+
+} // namespace
+
+BENCHMARK(BM_arena_delegate);
+BENCHMARK(BM_std_function_heap);
@@ -0,0 +1,80 @@
+/*
+ * atomic_bench.cpp
+ *
+ * Call throughput of atomic_delegate with 1-64 reader threads, while thread 0
+ * also replaces the delegate regularly. Compared with a mutex protected
+ * delegate.
+ */
+
+#include "delegate/atomic_delegate.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+
+namespace
+{
+
+struct Obj
+{
+    int get(int x) const
+    {
+        return x + m_val;
+    }
+    int m_val;
+};
+
+Obj s_a{1};
+Obj s_b{2};
+
+using Del = delegate<int(int)>;
+
+// Thread 0 store a new delegate every kStoreInterval calls.
+constexpr unsigned kStoreInterval = 1024;
+
+template <typename Storage>
+void
+BM_atomic_delegate(benchmark::State& state)
+{
+    static atomic_delegate<int(int), Storage> s_del{
+        Del::make<Obj, &Obj::get>(s_a)};
+    unsigned i = 0;
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0 && ++i % kStoreInterval == 0)
+            s_del.store(Del::make<Obj, &Obj::get>(i & kStoreInterval ? s_a : s_b));
+        benchmark::DoNotOptimize(s_del(1));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void
+BM_mutex_delegate(benchmark::State& state)
+{
+    static std::mutex s_mutex;
+    static Del s_del = Del::make<Obj, &Obj::get>(s_a);
+    unsigned i = 0;
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0 && ++i % kStoreInterval == 0)
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            s_del = Del::make<Obj, &Obj::get>(i & kStoreInterval ? s_a : s_b);
+        }
+        std::lock_guard<std::mutex> lock(s_mutex);
+        benchmark::DoNotOptimize(s_del(1));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_atomic_delegate, details::versioned_atomic_storage)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+#ifdef DELEGATE_HAVE_DWCAS
+BENCHMARK_TEMPLATE(BM_atomic_delegate, details::dwcas_atomic_storage)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+#endif
+BENCHMARK(BM_mutex_delegate)->ThreadRange(1, 64)->UseRealTime();
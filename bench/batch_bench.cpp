@@ -0,0 +1,81 @@
+/*
+ * batch_bench.cpp
+ *
+ * Per element callbacks over a buffer of samples. Compares calling a
+ * delegate for each element with one call of a batch_delegate for the
+ * whole buffer, where the target is inlined into the loop.
+ */
+
+#include "delegate/batch_delegate.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t kSamples = 4096;
+
+struct Sample
+{
+    float value;
+};
+
+struct Gain
+{
+    void add(Sample const& s)
+    {
+        m_sum += s.value * m_gain;
+    }
+    float m_gain = 0.5f;
+    float m_sum = 0.0f;
+};
+
+std::vector<Sample>
+makeSamples()
+{
+    std::vector<Sample> res(kSamples);
+    for (std::size_t i = 0; i < kSamples; ++i)
+        res[i].value = static_cast<float>(i % 17);
+    return res;
+}
+
+void
+BM_batch_elementwise(benchmark::State& state)
+{
+    Gain gain;
+    std::vector<Sample> samples = makeSamples();
+    auto d = delegate<void(Sample const&)>::make<Gain, &Gain::add>(gain);
+    benchmark::DoNotOptimize(d);
+    for (auto _ : state)
+    {
+        for (auto& s : samples)
+            d(s);
+        benchmark::ClobberMemory();
+    }
+    benchmark::DoNotOptimize(gain.m_sum);
+    state.SetItemsProcessed(state.iterations() * kSamples);
+}
+
+void
+BM_batch_delegate(benchmark::State& state)
+{
+    Gain gain;
+    std::vector<Sample> samples = makeSamples();
+    auto d = batch_delegate<void(Sample const&)>::make<Gain, &Gain::add>(gain);
+    benchmark::DoNotOptimize(d);
+    for (auto _ : state)
+    {
+        d(samples);
+        benchmark::ClobberMemory();
+    }
+    benchmark::DoNotOptimize(gain.m_sum);
+    state.SetItemsProcessed(state.iterations() * kSamples);
+}
+
+} // namespace
+
+BENCHMARK(BM_batch_elementwise);
+BENCHMARK(BM_batch_delegate);
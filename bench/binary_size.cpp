@@ -0,0 +1,46 @@
+/*
+ * binary_size.cpp
+ *
+ * Add the size of the benchmark executable to the benchmark context, so
+ * code size is tracked together with the timings, e.g. in the JSON output.
+ *
+ * Per trampoline sizes are listed by the 'delegate_codesize_report' target.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <string>
+
+#if defined(__linux__) && defined(__GNUC__)
+
+// Provided by the default GNU linker scripts.
+extern "C" char __executable_start;
+extern "C" char etext;
+
+namespace
+{
+
+std::string
+fileSize(char const* path)
+{
+    std::ifstream f{path, std::ios::binary | std::ios::ate};
+    return f ? std::to_string(static_cast<long long>(f.tellg())) : "unknown";
+}
+
+struct RegisterBinarySize
+{
+    RegisterBinarySize()
+    {
+        benchmark::AddCustomContext("binary_bytes", fileSize("/proc/self/exe"));
+        // Start of the image up to the end of .text.
+        benchmark::AddCustomContext(
+            "text_bytes", std::to_string(&etext - &__executable_start));
+    }
+};
+
+RegisterBinarySize const s_register;
+
+} // namespace
+
+#endif
@@ -0,0 +1,174 @@
+/*
+ * codesize_corpus.cpp
+ *
+ * Representative use of delegate for the trampoline code size audit.
+ *
+ * A handful of signatures, each bound to the usual kinds of targets: free
+ * functions, member functions, functors and lambdas, runtime function
+ * pointers and null. The 'delegate_codesize_report' target builds this with
+ * -Os and lists the size and number of instantiations of each trampoline.
+ */
+
+#include "delegate/delegate.hpp"
+
+namespace corpus
+{
+
+struct Msg
+{
+    int id;
+    unsigned char payload[32];
+};
+
+struct Device
+{
+    void reset()
+    {
+        ++m_resets;
+    }
+    void irq(int line)
+    {
+        m_last = line;
+    }
+    int status(int reg) const
+    {
+        return m_last + reg;
+    }
+    void onMsg(Msg const& m)
+    {
+        m_last = m.id;
+    }
+    bool write(char const* data, unsigned len)
+    {
+        m_last = len ? data[0] : 0;
+        return len != 0;
+    }
+
+    int m_resets = 0;
+    int m_last = 0;
+};
+
+struct Counter
+{
+    void operator()(int x)
+    {
+        m_sum += x;
+    }
+    int m_sum = 0;
+};
+
+int g_sink = 0;
+
+void
+tick()
+{
+    ++g_sink;
+}
+void
+irqHandler(int line)
+{
+    g_sink += line;
+}
+void
+irqHandlerNoexcept(int line) noexcept
+{
+    g_sink -= line;
+}
+int
+scale(int x)
+{
+    return 3 * x;
+}
+void
+logMsg(Msg const& m)
+{
+    g_sink ^= m.id;
+}
+bool
+writeLog(char const*, unsigned len)
+{
+    return len > 4;
+}
+void
+deviceIrq(Device& d, int line)
+{
+    d.irq(line + 1);
+}
+
+Device g_device;
+Counter g_counter;
+
+using VoidDel = delegate<void()>;
+using IrqDel = delegate<void(int)>;
+using IrqNeDel = delegate<void(int) noexcept>;
+using IntDel = delegate<int(int)>;
+using MsgDel = delegate<void(Msg const&)>;
+using WriteDel = delegate<bool(char const*, unsigned)>;
+
+// Filled in at run time, so the compiler can not see which target each
+// delegate call.
+VoidDel g_void[4];
+IrqDel g_irq[6];
+IrqNeDel g_irqNe[2];
+IntDel g_int[4];
+MsgDel g_msg[4];
+WriteDel g_write[3];
+
+void
+bind()
+{
+    auto const lambda = [](int x) { g_sink += x; };
+    static auto s_lambda = lambda;
+    static auto const s_clambda = lambda;
+
+    g_void[0] = VoidDel::make<tick>();
+    g_void[1] = VoidDel::make<Device, &Device::reset>(g_device);
+    g_void[2] = VoidDel::make(tick);
+
+    g_irq[0] = IrqDel::make<irqHandler>();
+    g_irq[1] = IrqDel::make<Device, &Device::irq>(g_device);
+    g_irq[2] = IrqDel::make(g_counter);
+    // Same lambda type bound as non-const and const.
+    g_irq[3] = IrqDel::make(s_lambda);
+    g_irq[4] = IrqDel::make(s_clambda);
+    g_irq[5] = IrqDel::make_free_with_object<Device, deviceIrq>(g_device);
+
+    g_irqNe[0] = IrqNeDel::make<irqHandlerNoexcept>();
+    g_irqNe[1] = IrqNeDel::make(irqHandlerNoexcept);
+
+    g_int[0] = IntDel::make<scale>();
+    g_int[1] = IntDel::make<Device, &Device::status>(g_device);
+    g_int[2] = IntDel::make(scale);
+
+    g_msg[0] = MsgDel::make<logMsg>();
+    g_msg[1] = MsgDel::make<Device, &Device::onMsg>(g_device);
+    g_msg[2] = MsgDel::make(logMsg);
+
+    g_write[0] = WriteDel::make<writeLog>();
+    g_write[1] = WriteDel::make<Device, &Device::write>(g_device);
+}
+
+template <typename Del, unsigned n, typename... Args>
+void
+callAll(Del (&dels)[n], Args... args)
+{
+    for (auto& d : dels)
+        d(args...);
+}
+
+} // namespace corpus
+
+int
+main(int argc, char**)
+{
+    using namespace corpus;
+    bind();
+    Msg m{argc, {}};
+    callAll(g_void);
+    callAll(g_irq, argc);
+    callAll(g_irqNe, argc);
+    callAll(g_int, argc);
+    callAll(g_msg, static_cast<Msg const&>(m));
+    callAll(g_write, "abc", static_cast<unsigned>(argc));
+    return g_sink == 42 ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * delegate_array_bench.cpp
+ *
+ * Dispatch of 50k timer callbacks, spread over 16 different member
+ * functions in pseudo random order. Compares an array of delegates with
+ * delegate_array, unsorted and sorted by trampoline.
+ */
+
+#include "delegate/delegate_array.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t kTimers = 50000;
+constexpr int kKinds = 16;
+
+template <int I>
+struct Timer
+{
+    void onTick(int x)
+    {
+        m_sum += x + I;
+    }
+    int m_sum = 0;
+};
+
+using Del = delegate<void(int)>;
+
+template <int I>
+Timer<I>*
+timers()
+{
+    static Timer<I> t[kTimers / kKinds + 1];
+    return t;
+}
+
+template <int I>
+Del
+makeDel(std::size_t ix)
+{
+    return Del::make<Timer<I>, &Timer<I>::onTick>(timers<I>()[ix]);
+}
+
+using MakeFkn = Del (*)(std::size_t);
+
+constexpr MakeFkn s_make[kKinds] = {
+    makeDel<0>,  makeDel<1>,  makeDel<2>,  makeDel<3>,
+    makeDel<4>,  makeDel<5>,  makeDel<6>,  makeDel<7>,
+    makeDel<8>,  makeDel<9>,  makeDel<10>, makeDel<11>,
+    makeDel<12>, makeDel<13>, makeDel<14>, makeDel<15>};
+
+// Same pseudo random sequence of targets for all benchmarks.
+std::vector<Del>
+makeTimers()
+{
+    std::mt19937 rng{42};
+    std::vector<Del> res;
+    res.reserve(kTimers);
+    for (std::size_t i = 0; i < kTimers; ++i)
+        res.push_back(s_make[rng() % kKinds](i / kKinds));
+    return res;
+}
+
+void
+BM_timers_delegate_vector(benchmark::State& state)
+{
+    std::vector<Del> dels = makeTimers();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dels.data());
+        for (auto& d : dels)
+            d(1);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kTimers);
+}
+
+template <bool sorted>
+void
+BM_timers_delegate_array(benchmark::State& state)
+{
+    static delegate_array<void(int), kTimers> s_arr;
+    s_arr.clear();
+    for (auto& d : makeTimers())
+        s_arr.push_back(d);
+    if (sorted)
+        s_arr.sort_by_trampoline();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(&s_arr);
+        s_arr.invoke_all(1);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kTimers);
+}
+
+} // namespace
+
+BENCHMARK(BM_timers_delegate_vector);
+BENCHMARK_TEMPLATE(BM_timers_delegate_array, false);
+BENCHMARK_TEMPLATE(BM_timers_delegate_array, true);
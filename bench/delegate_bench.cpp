@@ -0,0 +1,341 @@
+/*
+ * delegate_bench.cpp
+ *
+ * Micro benchmarks for the delegate call paths, compared against
+ * std::function, raw function pointers and virtual dispatch.
+ *
+ * Each call mechanism is measured in 4 configurations:
+ * - mono/hot  : One target, same call site, warm caches.
+ * - poly/hot  : Several targets called through the same call site in a
+ *               pseudo random order, warm caches.
+ * - mono/cold : One target, I-cache evicted before each call.
+ * - poly/cold : Several targets, I-cache evicted before each call.
+ */
+
+#include "delegate/delegate.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#define BENCH_NOINLINE __attribute__((noinline))
+
+namespace
+{
+
+// Number of distinct targets used for the polymorphic call sites.
+constexpr unsigned kTargets = 4;
+
+// Number of calls done per timed iteration for hot cache runs.
+constexpr unsigned kHotCalls = 256;
+
+// ---------------------------------------------------------------------------
+// I-cache eviction. Call a large number of distinct functions, big enough
+// to push the code under test out of L1i (and most of L2).
+
+template <unsigned I>
+BENCH_NOINLINE int
+filler(int x)
+{
+    asm volatile(".rept 64\n\tnop\n\t.endr" ::: "memory");
+    return x + static_cast<int>(I);
+}
+
+template <std::size_t... Is>
+constexpr std::array<int (*)(int), sizeof...(Is)>
+makeFillers(std::index_sequence<Is...>)
+{
+    return {{&filler<Is>...}};
+}
+
+const auto s_fillers = makeFillers(std::make_index_sequence<2048>{});
+
+void
+evictICache()
+{
+    int acc = 0;
+    for (auto f : s_fillers)
+        acc = f(acc);
+    benchmark::DoNotOptimize(acc);
+}
+
+// Pseudo random target sequence for the polymorphic call sites. Any
+// simple pattern would be learned by the indirect branch predictor.
+std::array<std::uint8_t, kHotCalls>
+makePattern()
+{
+    std::array<std::uint8_t, kHotCalls> p{};
+    std::uint32_t x = 0x12345678u;
+    for (auto& v : p)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        v = static_cast<std::uint8_t>(x % kTargets);
+    }
+    return p;
+}
+
+const auto s_pattern = makePattern();
+
+// ---------------------------------------------------------------------------
+// Call targets. One instantiation per target index.
+
+template <int I>
+int
+freeTarget(int x)
+{
+    return x + I;
+}
+
+template <int I>
+int
+freeTargetWithVoid(void* ctx, int x)
+{
+    return x + *static_cast<int*>(ctx) + I;
+}
+
+template <int I>
+struct Target
+{
+    int m_state = I;
+
+    int member(int x)
+    {
+        return x + m_state;
+    }
+    int cmember(int x) const
+    {
+        return x + m_state + 1;
+    }
+    int operator()(int x)
+    {
+        return x + m_state + 2;
+    }
+};
+
+template <int I>
+Target<I>&
+target()
+{
+    static Target<I> t;
+    return t;
+}
+
+struct Iface
+{
+    virtual ~Iface() = default;
+    virtual int call(int x) = 0;
+};
+
+template <int I>
+struct Impl : Iface
+{
+    int call(int x) override
+    {
+        return x + I;
+    }
+};
+
+template <int I>
+Iface*
+iface()
+{
+    static Impl<I> impl;
+    return &impl;
+}
+
+// ---------------------------------------------------------------------------
+// Call mechanisms. Each provide a 'Callable' type and a 'make<I>()' returning
+// a callable for target I.
+
+using Del = delegate<int(int)>;
+
+struct DelegateFree
+{
+    using Callable = Del;
+    template <int I>
+    static Callable make()
+    {
+        return Del::make<freeTarget<I>>();
+    }
+};
+
+struct DelegateMember
+{
+    using Callable = Del;
+    template <int I>
+    static Callable make()
+    {
+        return Del::make<Target<I>, &Target<I>::member>(target<I>());
+    }
+};
+
+struct DelegateConstMember
+{
+    using Callable = Del;
+    template <int I>
+    static Callable make()
+    {
+        Target<I> const& t = target<I>();
+        return Del::make<Target<I>, &Target<I>::cmember>(t);
+    }
+};
+
+struct DelegateFunctor
+{
+    using Callable = Del;
+    template <int I>
+    static Callable make()
+    {
+        return Del::make(target<I>());
+    }
+};
+
+struct DelegateFreeWithVoid
+{
+    using Callable = Del;
+    template <int I>
+    static Callable make()
+    {
+        return Del::make_free_with_void<freeTargetWithVoid<I>>(
+            static_cast<void*>(&target<I>().m_state));
+    }
+};
+
+struct DelegateRuntimeFkn
+{
+    using Callable = Del;
+    template <int I>
+    static Callable make()
+    {
+        return Del::make(&freeTarget<I>);
+    }
+};
+
+struct DelegateNull
+{
+    using Callable = Del;
+    template <int>
+    static Callable make()
+    {
+        return Del{};
+    }
+};
+
+struct StdFunction
+{
+    using Callable = std::function<int(int)>;
+    template <int I>
+    static Callable make()
+    {
+        Target<I>* t = &target<I>();
+        return [t](int x) { return t->member(x); };
+    }
+};
+
+struct FunctionPointer
+{
+    using Callable = int (*)(int);
+    template <int I>
+    static Callable make()
+    {
+        return &freeTarget<I>;
+    }
+};
+
+struct Virtual
+{
+    struct Callable
+    {
+        Iface* m_obj;
+        int operator()(int x) const
+        {
+            return m_obj->call(x);
+        }
+    };
+    template <int I>
+    static Callable make()
+    {
+        return Callable{iface<I>()};
+    }
+};
+
+template <class Kind, bool poly>
+std::array<typename Kind::Callable, kTargets>
+makeTable()
+{
+    using C = typename Kind::Callable;
+    if (poly)
+        return {{Kind::template make<0>(), Kind::template make<1>(),
+                 Kind::template make<2>(), Kind::template make<3>()}};
+    C c = Kind::template make<0>();
+    return {{c, c, c, c}};
+}
+
+// ---------------------------------------------------------------------------
+// The benchmarks.
+
+template <class Kind, bool poly>
+void
+BM_hot(benchmark::State& state)
+{
+    auto table = makeTable<Kind, poly>();
+    for (auto _ : state)
+    {
+        // Hide the table contents from the optimizer so every call is a real
+        // indirect call through the same call site.
+        benchmark::DoNotOptimize(table.data());
+        benchmark::ClobberMemory();
+        int acc = 0;
+        for (unsigned i = 0; i < kHotCalls; ++i)
+            acc += table[poly ? s_pattern[i] : 0](static_cast<int>(i));
+        benchmark::DoNotOptimize(acc);
+    }
+    state.SetItemsProcessed(state.iterations() * kHotCalls);
+}
+
+template <class Kind, bool poly>
+void
+BM_cold(benchmark::State& state)
+{
+    auto table = makeTable<Kind, poly>();
+    unsigned ix = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        evictICache();
+        benchmark::DoNotOptimize(table.data());
+        benchmark::ClobberMemory();
+        state.ResumeTiming();
+
+        int acc = table[poly ? s_pattern[ix % kHotCalls] : 0](1);
+        benchmark::DoNotOptimize(acc);
+        ix++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+#define DELEGATE_BENCH(Kind)                     \
+    BENCHMARK_TEMPLATE(BM_hot, Kind, false);     \
+    BENCHMARK_TEMPLATE(BM_hot, Kind, true);      \
+    BENCHMARK_TEMPLATE(BM_cold, Kind, false);    \
+    BENCHMARK_TEMPLATE(BM_cold, Kind, true)
+
+DELEGATE_BENCH(DelegateFree);
+DELEGATE_BENCH(DelegateMember);
+DELEGATE_BENCH(DelegateConstMember);
+DELEGATE_BENCH(DelegateFunctor);
+DELEGATE_BENCH(DelegateFreeWithVoid);
+DELEGATE_BENCH(DelegateRuntimeFkn);
+BENCHMARK_TEMPLATE(BM_hot, DelegateNull, false);
+BENCHMARK_TEMPLATE(BM_cold, DelegateNull, false);
+
+DELEGATE_BENCH(StdFunction);
+DELEGATE_BENCH(FunctionPointer);
+DELEGATE_BENCH(Virtual);
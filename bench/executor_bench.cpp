@@ -0,0 +1,177 @@
+/*
+ * executor_bench.cpp
+ *
+ * Throughput of small tasks on a thread pool, 1 to 64 worker threads.
+ * delegate_executor compared with a typical std::function pool: one
+ * mutex protected std::deque and a condition variable. Each iteration
+ * submits kTasks tasks from the benchmark thread and waits for them.
+ */
+
+#include "delegate/executor.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr int kTasks = 10000;
+
+struct Counter
+{
+    void inc()
+    {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::atomic<int> count{0};
+};
+
+// Reference: std::function tasks in a shared queue.
+class function_pool
+{
+  public:
+    explicit function_pool(unsigned threads)
+    {
+        for (unsigned i = 0; i < threads; ++i)
+            m_threads.emplace_back([this] { run(); });
+    }
+    ~function_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto& t : m_threads)
+            t.join();
+    }
+    void submit(std::function<void()> f)
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_queue.push_back(std::move(f));
+        }
+        m_cv.notify_one();
+    }
+
+  private:
+    void run()
+    {
+        for (;;)
+        {
+            std::function<void()> f;
+            {
+                std::unique_lock<std::mutex> lock{m_mutex};
+                while (!m_stop && m_queue.empty())
+                    m_cv.wait_for(lock, std::chrono::milliseconds(10));
+                if (m_queue.empty())
+                    return;
+                f = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            f();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_queue;
+    std::vector<std::thread> m_threads;
+    bool m_stop = false;
+};
+
+void
+waitFor(Counter const& c, int n)
+{
+    while (c.count.load(std::memory_order_relaxed) < n)
+        std::this_thread::yield();
+}
+
+void
+BM_pool_std_function(benchmark::State& state)
+{
+    function_pool pool{static_cast<unsigned>(state.range(0))};
+    Counter c;
+    int expected = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < kTasks; ++i)
+            pool.submit([&c] { c.inc(); });
+        expected += kTasks;
+        waitFor(c, expected);
+    }
+    state.SetItemsProcessed(state.iterations() * kTasks);
+}
+
+void
+BM_pool_delegate_executor(benchmark::State& state)
+{
+    delegate_executor pool{static_cast<unsigned>(state.range(0)), kTasks};
+    Counter c;
+    int expected = 0;
+    auto const task = delegate<void()>::make<Counter, &Counter::inc>(c);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < kTasks; ++i)
+            pool.submit(task);
+        expected += kTasks;
+        waitFor(c, expected);
+    }
+    state.SetItemsProcessed(state.iterations() * kTasks);
+}
+
+void
+BM_pool_delegate_executor_batch(benchmark::State& state)
+{
+    delegate_executor pool{static_cast<unsigned>(state.range(0)), kTasks};
+    Counter c;
+    int expected = 0;
+    std::vector<delegate<void()>> tasks(
+        kTasks, delegate<void()>::make<Counter, &Counter::inc>(c));
+    for (auto _ : state)
+    {
+        pool.submit(tasks.data(), tasks.size());
+        expected += kTasks;
+        waitFor(c, expected);
+    }
+    state.SetItemsProcessed(state.iterations() * kTasks);
+}
+
+void
+BM_pool_parallel_for(benchmark::State& state)
+{
+    delegate_executor pool{static_cast<unsigned>(state.range(0))};
+    std::vector<int> v(kTasks * 16, 1);
+    std::atomic<long> sum{0};
+    auto body = [&](std::size_t first, std::size_t last) {
+        long s = 0;
+        for (std::size_t i = first; i < last; ++i)
+            s += v[i];
+        sum.fetch_add(s, std::memory_order_relaxed);
+    };
+    for (auto _ : state)
+        pool.parallel_for(0, v.size(), 1024,
+                          delegate_executor::RangeTask::make(body));
+    benchmark::DoNotOptimize(sum.load());
+    state.SetItemsProcessed(state.iterations() * v.size());
+}
+
+} // namespace
+
+BENCHMARK(BM_pool_std_function)->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+BENCHMARK(BM_pool_delegate_executor)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime();
+BENCHMARK(BM_pool_delegate_executor_batch)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime();
+BENCHMARK(BM_pool_parallel_for)->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
@@ -0,0 +1,131 @@
+/*
+ * flat_set_bench.cpp
+ *
+ * Calling all delegates of a subscription table of 256 listeners, stored
+ * in a std::set with delegate::Less and in a flat_delegate_set. Also the
+ * cost of subscribing the table one by one and in bulk, for 256 and 4096
+ * listeners.
+ */
+
+#include "delegate/flat_delegate_set.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <set>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t kListeners = 256;
+
+struct Listener
+{
+    void onEvent(int x)
+    {
+        m_sum += x;
+    }
+    void onOther(int x)
+    {
+        m_sum -= x;
+    }
+    int m_sum = 0;
+};
+
+using Del = delegate<void(int)>;
+using FlatSet = flat_delegate_set<void(int), kListeners>;
+
+std::vector<Del>
+makeDelegates(std::vector<Listener>& l)
+{
+    std::vector<Del> res;
+    for (std::size_t i = 0; i < l.size(); ++i)
+    {
+        if (i % 2)
+            res.push_back(Del::make<Listener, &Listener::onEvent>(l[i]));
+        else
+            res.push_back(Del::make<Listener, &Listener::onOther>(l[i]));
+    }
+    return res;
+}
+
+void
+BM_std_set_dispatch(benchmark::State& state)
+{
+    std::vector<Listener> listeners(kListeners);
+    std::vector<Del> dels = makeDelegates(listeners);
+    // Interleave with other allocations, as in a long running program.
+    std::vector<std::vector<char>> noise;
+    std::set<Del, Del::Less> set;
+    for (auto& d : dels)
+    {
+        set.insert(d);
+        noise.emplace_back(48);
+    }
+    for (auto _ : state)
+    {
+        for (auto& d : set)
+            d(1);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kListeners);
+}
+
+void
+BM_flat_set_dispatch(benchmark::State& state)
+{
+    std::vector<Listener> listeners(kListeners);
+    std::vector<Del> dels = makeDelegates(listeners);
+    static FlatSet set;
+    set.clear();
+    set.insert(dels.data(), dels.size());
+    for (auto _ : state)
+    {
+        set.invoke_all(1);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kListeners);
+}
+
+template <std::size_t N>
+void
+BM_flat_set_insert_each(benchmark::State& state)
+{
+    std::vector<Listener> listeners(N);
+    std::vector<Del> dels = makeDelegates(listeners);
+    static flat_delegate_set<void(int), N> set;
+    for (auto _ : state)
+    {
+        set.clear();
+        for (auto& d : dels)
+            set.insert(d);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+template <std::size_t N>
+void
+BM_flat_set_insert_bulk(benchmark::State& state)
+{
+    std::vector<Listener> listeners(N);
+    std::vector<Del> dels = makeDelegates(listeners);
+    static flat_delegate_set<void(int), N> set;
+    for (auto _ : state)
+    {
+        set.clear();
+        set.insert(dels.data(), dels.size());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+} // namespace
+
+BENCHMARK(BM_std_set_dispatch);
+BENCHMARK(BM_flat_set_dispatch);
+BENCHMARK_TEMPLATE(BM_flat_set_insert_each, kListeners);
+BENCHMARK_TEMPLATE(BM_flat_set_insert_bulk, kListeners);
+BENCHMARK_TEMPLATE(BM_flat_set_insert_each, 4096);
+BENCHMARK_TEMPLATE(BM_flat_set_insert_bulk, 4096);
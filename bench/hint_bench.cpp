@@ -0,0 +1,93 @@
+/*
+ * hint_bench.cpp
+ *
+ * Guarded devirtualization. A loop calling packet handlers where 95% of
+ * the delegates call the same member function. Compares a plain call with
+ * 'call_with_hint' for the common target, which can then be inlined.
+ */
+
+#include "delegate/delegate.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t kPackets = 4096;
+
+struct Conn
+{
+    void onPacket(int len)
+    {
+        m_bytes += len;
+    }
+    int m_bytes = 0;
+};
+
+struct Control
+{
+    void onPacket(int len)
+    {
+        m_bytes -= len;
+    }
+    int m_bytes = 0;
+};
+
+using Del = delegate<void(int)>;
+
+std::vector<Del>
+makeHandlers(Conn& conn, Control& ctrl)
+{
+    std::mt19937 rng{42};
+    std::vector<Del> res;
+    res.reserve(kPackets);
+    for (std::size_t i = 0; i < kPackets; ++i)
+    {
+        if (rng() % 100 < 95)
+            res.push_back(Del::make<Conn, &Conn::onPacket>(conn));
+        else
+            res.push_back(Del::make<Control, &Control::onPacket>(ctrl));
+    }
+    return res;
+}
+
+void
+BM_hint_plain_call(benchmark::State& state)
+{
+    Conn conn;
+    Control ctrl;
+    std::vector<Del> dels = makeHandlers(conn, ctrl);
+    for (auto _ : state)
+    {
+        for (auto& d : dels)
+            d(1);
+        benchmark::ClobberMemory();
+    }
+    benchmark::DoNotOptimize(conn.m_bytes + ctrl.m_bytes);
+    state.SetItemsProcessed(state.iterations() * kPackets);
+}
+
+void
+BM_hint_call_with_hint(benchmark::State& state)
+{
+    Conn conn;
+    Control ctrl;
+    std::vector<Del> dels = makeHandlers(conn, ctrl);
+    for (auto _ : state)
+    {
+        for (auto& d : dels)
+            d.call_with_hint<&Conn::onPacket>(1);
+        benchmark::ClobberMemory();
+    }
+    benchmark::DoNotOptimize(conn.m_bytes + ctrl.m_bytes);
+    state.SetItemsProcessed(state.iterations() * kPackets);
+}
+
+} // namespace
+
+BENCHMARK(BM_hint_plain_call);
+BENCHMARK(BM_hint_call_with_hint);
@@ -0,0 +1,109 @@
+/*
+ * multicast_bench.cpp
+ *
+ * Dispatch cost per listener for multicast_delegate, compared to calling
+ * N separate delegates, and to the hand rolled array + null check loop.
+ */
+
+#include "delegate/multicast_delegate.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+
+namespace
+{
+
+struct Listener
+{
+    void onEvent(int x)
+    {
+        m_sum += x;
+    }
+    int m_sum = 0;
+};
+
+using Del = delegate<void(int)>;
+
+template <std::size_t N>
+std::array<Listener, N>&
+listeners()
+{
+    static std::array<Listener, N> l;
+    return l;
+}
+
+template <std::size_t N>
+void
+BM_multicast(benchmark::State& state)
+{
+    multicast_delegate<void(int), N> m;
+    for (auto& l : listeners<N>())
+        m.add(Del::make<Listener, &Listener::onEvent>(l));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(&m);
+        m(1);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+// N separate delegate::operator() calls.
+template <std::size_t N>
+void
+BM_separate_delegates(benchmark::State& state)
+{
+    std::array<Del, N> dels;
+    for (std::size_t i = 0; i < N; ++i)
+        dels[i] = Del::make<Listener, &Listener::onEvent>(listeners<N>()[i]);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dels.data());
+        for (auto& d : dels)
+            d(1);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+// Hand rolled version, half filled array of delegates with null check.
+template <std::size_t N>
+void
+BM_array_with_null_check(benchmark::State& state)
+{
+    std::array<Del, 2 * N> dels;
+    for (std::size_t i = 0; i < N; ++i)
+        dels[2 * i] =
+            Del::make<Listener, &Listener::onEvent>(listeners<N>()[i]);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dels.data());
+        for (auto& d : dels)
+        {
+            if (d)
+                d(1);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_multicast, 1);
+BENCHMARK_TEMPLATE(BM_multicast, 4);
+BENCHMARK_TEMPLATE(BM_multicast, 16);
+BENCHMARK_TEMPLATE(BM_multicast, 64);
+BENCHMARK_TEMPLATE(BM_separate_delegates, 1);
+BENCHMARK_TEMPLATE(BM_separate_delegates, 4);
+BENCHMARK_TEMPLATE(BM_separate_delegates, 16);
+BENCHMARK_TEMPLATE(BM_separate_delegates, 64);
+BENCHMARK_TEMPLATE(BM_array_with_null_check, 1);
+BENCHMARK_TEMPLATE(BM_array_with_null_check, 4);
+BENCHMARK_TEMPLATE(BM_array_with_null_check, 16);
+BENCHMARK_TEMPLATE(BM_array_with_null_check, 64);
@@ -0,0 +1,104 @@
+/*
+ * noexcept_bench.cpp
+ *
+ * Dispatch loop over delegate<void(int)> compared with
+ * delegate<void(int) noexcept>. The loop keep an object with a non-trivial
+ * destructor alive over the call. A call which may throw needs a landing
+ * pad running the destructor, the noexcept call does not.
+ *
+ * Code size of the two loops is printed by the 'delegate_codesize' target.
+ */
+
+#include "delegate/delegate.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace codesize
+{
+
+struct Guard
+{
+    explicit Guard(int& count) : m_count(count)
+    {
+        ++m_count;
+    }
+    ~Guard()
+    {
+        --m_count;
+        benchmark::DoNotOptimize(m_count);
+    }
+    int& m_count;
+};
+
+using Del = delegate<void(int)>;
+using NoexceptDel = delegate<void(int) noexcept>;
+
+// Out of line and with external linkage to be visible for nm.
+__attribute__((noinline)) int
+dispatch_delegate(Del const* dels, std::size_t n)
+{
+    int count = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        Guard g{count};
+        dels[i](static_cast<int>(i));
+    }
+    return count;
+}
+
+__attribute__((noinline)) int
+dispatch_noexcept_delegate(NoexceptDel const* dels, std::size_t n)
+{
+    int count = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        Guard g{count};
+        dels[i](static_cast<int>(i));
+    }
+    return count;
+}
+
+} // namespace codesize
+
+namespace
+{
+
+int s_sum = 0;
+
+void
+handler(int x) noexcept
+{
+    s_sum += x;
+}
+
+constexpr std::size_t kHandlers = 256;
+
+void
+BM_dispatch_delegate(benchmark::State& state)
+{
+    std::vector<codesize::Del> dels(kHandlers,
+                                    codesize::Del::make<handler>());
+    for (auto _ : state)
+        benchmark::DoNotOptimize(
+            codesize::dispatch_delegate(dels.data(), dels.size()));
+    state.SetItemsProcessed(state.iterations() * kHandlers);
+}
+
+void
+BM_dispatch_noexcept_delegate(benchmark::State& state)
+{
+    std::vector<codesize::NoexceptDel> dels(
+        kHandlers, codesize::NoexceptDel::make<handler>());
+    for (auto _ : state)
+        benchmark::DoNotOptimize(
+            codesize::dispatch_noexcept_delegate(dels.data(), dels.size()));
+    state.SetItemsProcessed(state.iterations() * kHandlers);
+}
+
+} // namespace
+
+BENCHMARK(BM_dispatch_delegate);
+BENCHMARK(BM_dispatch_noexcept_delegate);
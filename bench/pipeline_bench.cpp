@@ -0,0 +1,100 @@
+/*
+ * pipeline_bench.cpp
+ *
+ * A decode -> validate -> route chain per message. Compares three separate
+ * delegates, one indirect call per stage, with one delegate to the stages
+ * fused by 'compose'.
+ */
+
+#include "delegate/delegate_pipeline.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace
+{
+
+constexpr int kMessages = 1024;
+
+struct Frame
+{
+    std::uint32_t header;
+    std::uint32_t payload;
+};
+
+struct Decoder
+{
+    Frame decode(std::uint32_t raw) const
+    {
+        return Frame{raw >> 24, raw & 0xffffffu};
+    }
+};
+
+struct Validator
+{
+    Frame validate(Frame f) const
+    {
+        f.header = f.header < m_maxHeader ? f.header : 0;
+        return f;
+    }
+    std::uint32_t m_maxHeader = 200;
+};
+
+struct Router
+{
+    void route(Frame f)
+    {
+        m_sum[f.header & 3] += f.payload;
+    }
+    std::uint32_t m_sum[4] = {};
+};
+
+void
+BM_pipeline_separate_delegates(benchmark::State& state)
+{
+    Decoder dec;
+    Validator val;
+    Router router;
+    auto d1 = delegate<Frame(std::uint32_t)>::make<Decoder, &Decoder::decode>(
+        dec);
+    auto d2 =
+        delegate<Frame(Frame)>::make<Validator, &Validator::validate>(val);
+    auto d3 = delegate<void(Frame)>::make<Router, &Router::route>(router);
+    std::uint32_t raw = 0x12345678;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(d1);
+        benchmark::DoNotOptimize(d2);
+        benchmark::DoNotOptimize(d3);
+        for (int i = 0; i < kMessages; ++i)
+            d3(d2(d1(raw + i)));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kMessages);
+}
+
+void
+BM_pipeline_composed(benchmark::State& state)
+{
+    Decoder dec;
+    Validator val;
+    Router router;
+    auto p = compose<&Decoder::decode, &Validator::validate, &Router::route>(
+        dec, val, router);
+    auto d = p.view();
+    std::uint32_t raw = 0x12345678;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(d);
+        for (int i = 0; i < kMessages; ++i)
+            d(raw + i);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kMessages);
+}
+
+} // namespace
+
+BENCHMARK(BM_pipeline_separate_delegates);
+BENCHMARK(BM_pipeline_composed);
@@ -0,0 +1,135 @@
+/*
+ * queue_bench.cpp
+ *
+ * Throughput of posting delegate<void(int)> + int to a consumer thread.
+ * delegate_queue (SPSC and MPSC) compared with a mutex protected
+ * std::deque. The benchmark threads are producers, a separate consumer
+ * thread drains in batches of up to 64 calls.
+ */
+
+#include "delegate/delegate_queue.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace
+{
+
+struct Sink
+{
+    void onValue(int v)
+    {
+        m_sum += v;
+        m_count++;
+    }
+    long long m_sum = 0;
+    long long m_count = 0;
+};
+
+using Del = delegate<void(int)>;
+
+constexpr unsigned kBatch = 64;
+
+// Reference: mutex protected deque.
+class mutex_queue
+{
+  public:
+    bool push(Del const& d, int v)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.emplace_back(d, v);
+        return true;
+    }
+    unsigned drain(unsigned max)
+    {
+        std::pair<Del, int> batch[kBatch];
+        unsigned n = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (n < max && n < kBatch && !m_queue.empty())
+            {
+                batch[n++] = m_queue.front();
+                m_queue.pop_front();
+            }
+        }
+        for (unsigned i = 0; i < n; ++i)
+            batch[i].first(batch[i].second);
+        return n;
+    }
+
+  private:
+    std::mutex m_mutex;
+    std::deque<std::pair<Del, int>> m_queue;
+};
+
+// Consumer thread owned by benchmark thread 0.
+template <typename Queue>
+class consumer
+{
+  public:
+    explicit consumer(Queue& q)
+        : m_queue(q), m_thread([this] {
+              while (!m_stop.load(std::memory_order_relaxed))
+              {
+                  if (m_queue.drain(kBatch) == 0)
+                      std::this_thread::yield();
+              }
+              while (m_queue.drain(kBatch) != 0)
+              {
+              }
+          })
+    {
+    }
+    ~consumer()
+    {
+        m_stop = true;
+        m_thread.join();
+    }
+
+  private:
+    Queue& m_queue;
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+};
+
+template <typename Queue>
+void
+BM_post(benchmark::State& state)
+{
+    static Queue* s_queue;
+    static consumer<Queue>* s_consumer;
+    static Sink s_sink;
+    if (state.thread_index() == 0)
+    {
+        s_queue = new Queue;
+        s_consumer = new consumer<Queue>(*s_queue);
+    }
+    auto d = Del::make<Sink, &Sink::onValue>(s_sink);
+    for (auto _ : state)
+    {
+        // Let the consumer run when full, matters with few cores.
+        while (!s_queue->push(d, 1))
+            std::this_thread::yield();
+    }
+    if (state.thread_index() == 0)
+    {
+        // The loop end is a barrier, all producers are done.
+        delete s_consumer;
+        delete s_queue;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+using spsc_queue = delegate_queue<void(int), 1024, queue_spsc>;
+using mpsc_queue = delegate_queue<void(int), 1024, queue_mpsc>;
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_post, spsc_queue)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_post, mpsc_queue)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_post, mutex_queue)->ThreadRange(1, 8)->UseRealTime();
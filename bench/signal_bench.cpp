@@ -0,0 +1,95 @@
+/*
+ * signal_bench.cpp
+ *
+ * Emit throughput of concurrent_signal with 1-64 emitting threads, while
+ * thread 0 also subscribes and unsubscribes a listener regularly. Compared
+ * with a mutex protected multicast_delegate.
+ */
+
+#include "delegate/concurrent_signal.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+
+namespace
+{
+
+// Listeners only read, so the emitters share no written cache line.
+struct Book
+{
+    void onQuote(int price) const
+    {
+        benchmark::DoNotOptimize(price + m_offset);
+    }
+    int m_offset;
+};
+
+Book const s_books[4] = {{1}, {2}, {3}, {4}};
+
+using Del = delegate<void(int)>;
+
+// Thread 0 change the subscriptions every kUpdateInterval emits.
+constexpr unsigned kUpdateInterval = 1024;
+
+void
+BM_concurrent_signal(benchmark::State& state)
+{
+    static concurrent_signal<void(int), 8> s_sig;
+    if (state.thread_index() == 0)
+    {
+        s_sig.clear();
+        for (int i = 0; i < 3; ++i)
+            s_sig.subscribe(Del::make<Book, &Book::onQuote>(s_books[i]));
+    }
+    auto emitter = s_sig.get_emitter();
+    Del const extra = Del::make<Book, &Book::onQuote>(s_books[3]);
+    unsigned i = 0;
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0 && ++i % kUpdateInterval == 0)
+        {
+            if (i & kUpdateInterval)
+                s_sig.subscribe(extra);
+            else
+                s_sig.unsubscribe(extra);
+        }
+        emitter(1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void
+BM_mutex_multicast(benchmark::State& state)
+{
+    static std::mutex s_mutex;
+    static multicast_delegate<void(int), 8> s_sig;
+    if (state.thread_index() == 0)
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_sig.clear();
+        for (int i = 0; i < 3; ++i)
+            s_sig.add(Del::make<Book, &Book::onQuote>(s_books[i]));
+    }
+    Del const extra = Del::make<Book, &Book::onQuote>(s_books[3]);
+    unsigned i = 0;
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0 && ++i % kUpdateInterval == 0)
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            if (i & kUpdateInterval)
+                s_sig.add(extra);
+            else
+                s_sig.remove(extra);
+        }
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_sig(1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_concurrent_signal)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_mutex_multicast)->ThreadRange(1, 64)->UseRealTime();
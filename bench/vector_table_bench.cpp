@@ -0,0 +1,91 @@
+/*
+ * vector_table_bench.cpp
+ *
+ * Interrupt entry through a function pointer, as done by the hardware from
+ * its vector table. Compares one generic handler reading the active vector
+ * number and indexing an array of delegates, with the per vector handlers
+ * of delegate_vector_table. Host only, the cycle counts on a Cortex-M are
+ * not measured here.
+ */
+
+#include "delegate/delegate_vector_table.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+constexpr unsigned kVectors = 8;
+
+struct Device
+{
+    void onIrq()
+    {
+        ++m_count;
+    }
+    unsigned m_count = 0;
+};
+
+Device s_devices[kVectors];
+
+// Stands in for the interrupt controller's active vector register.
+volatile unsigned s_activeVector = 0;
+
+delegate<void()> s_generic[kVectors];
+
+void
+genericHandler()
+{
+    s_generic[s_activeVector]();
+}
+
+struct BenchIrq
+{
+};
+using Vectors = delegate_vector_table<kVectors, BenchIrq>;
+
+template <unsigned... I>
+void
+bindAll()
+{
+    using Del = Vectors::Delegate;
+    int dummy[] = {
+        (Vectors::set<I>(Del::make<Device, &Device::onIrq>(s_devices[I])),
+         0)...};
+    (void)dummy;
+}
+
+void
+BM_vector_generic_handler(benchmark::State& state)
+{
+    for (unsigned i = 0; i < kVectors; ++i)
+        s_generic[i] = delegate<void()>::make<Device, &Device::onIrq>(
+            s_devices[i]);
+    void (*volatile entry)() = &genericHandler;
+    unsigned v = 0;
+    for (auto _ : state)
+    {
+        s_activeVector = v++ % kVectors;
+        entry();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void
+BM_vector_table_handler(benchmark::State& state)
+{
+    bindAll<0, 1, 2, 3, 4, 5, 6, 7>();
+    static Vectors::handler_array const table = Vectors::handlers();
+    unsigned v = 0;
+    for (auto _ : state)
+    {
+        void (*volatile entry)() = table.value[v++ % kVectors];
+        entry();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_vector_generic_handler);
+BENCHMARK(BM_vector_table_handler);
@@ -0,0 +1,161 @@
+# check_codegen.cmake
+#
+# Check the generated code of functions against annotations in the source:
+#
+#   // codegen: <symbol regex> <kind> [max instructions]
+#
+# The regex is matched against the whole (mangled) symbol name, at least one
+# function must match. Kinds:
+#
+#   indirect_tail_call  Only loads and moves, ending with one indirect jump.
+#                       No calls, no stack use, at most 4 instructions.
+#   direct_tail_call    Only loads and moves, ending with one direct jump.
+#                       No calls, no stack use, at most 4 instructions.
+#   inlined             No calls, jumps or branches, ending with a return.
+#                       No stack use.
+#
+# An optional count lowers the allowed number of instructions, including the
+# final jump or return. Padding and landing pads are not counted.
+#
+# Run as:
+#   cmake -DOBJDUMP=<objdump> -DBINARY=<file> -DSOURCE=<file>
+#         [-DCXX=<compiler> -DCXX_FLAGS=<flags>] -P check_codegen.cmake
+#
+# With CXX given, SOURCE is first compiled into BINARY, e.g. with a cross
+# compiler.
+
+cmake_minimum_required(VERSION 3.4)
+
+if(NOT OBJDUMP OR NOT BINARY OR NOT SOURCE)
+    message(FATAL_ERROR "Usage: cmake -DOBJDUMP=<objdump> -DBINARY=<file> -DSOURCE=<file> -P check_codegen.cmake")
+endif()
+
+if(CXX)
+    separate_arguments(flags UNIX_COMMAND "${CXX_FLAGS}")
+    execute_process(
+        COMMAND ${CXX} ${flags} -c ${SOURCE} -o ${BINARY}
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Compiling ${SOURCE} with ${CXX} failed")
+    endif()
+endif()
+
+execute_process(
+    COMMAND ${OBJDUMP} -d --no-show-raw-insn ${BINARY}
+    OUTPUT_VARIABLE disasm
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${OBJDUMP} failed on ${BINARY}")
+endif()
+
+if(disasm MATCHES "aarch64")
+    set(arch aarch64)
+    set(indirect_jump "^br[ \t]+x[0-9]+$")
+    set(direct_jump "^b[ \t]+[0-9a-f]+")
+    set(bad "^(bl|blr|ret|stp|str)[ \t]|sp")
+    set(return "^ret$")
+    set(bad_inlined "^(bl|blr|stp)[ \t]|sp")
+else()
+    set(arch x86)
+    set(indirect_jump "^((notrack|bnd)[ \t]+)?jmp[ \t]+\\*")
+    set(direct_jump "^((notrack|bnd)[ \t]+)?jmp[ \t]+[0-9a-f]+ ")
+    set(bad "^(call|ret|push|pop|sub|add)[ \t]|%rsp")
+    set(return "^(repz[ \t]+|rep[ \t]+)?ret")
+    set(bad_inlined "^(call|push|pop)[ \t]|%rsp")
+endif()
+set(branch "^(j|b\\.|b[ \t]|br[ \t]|cb|tb)")
+
+# Collect the instructions of each function, 'insns_<n>' for the n:th.
+string(REPLACE ";" "," disasm "${disasm}")
+string(REPLACE "\n" ";" disasm "${disasm}")
+set(nfunctions 0)
+foreach(line IN LISTS disasm)
+    if(line MATCHES "^[0-9a-f]+ <(.+)>:$")
+        math(EXPR nfunctions "${nfunctions} + 1")
+        set(name_${nfunctions} "${CMAKE_MATCH_1}")
+        set(insns_${nfunctions} "")
+    elseif(nfunctions GREATER 0 AND line MATCHES "^ +[0-9a-f]+:[ \t]+(.+)$")
+        set(insn "${CMAKE_MATCH_1}")
+        string(REGEX REPLACE "[ \t]+#.*$|[ \t]*//.*$" "" insn "${insn}")
+        string(STRIP "${insn}" insn)
+        # Padding and landing pads.
+        if(insn MATCHES "^(nop|data16|xchg[ \t]+%ax,%ax|int3|endbr64|bti|udf|\\.inst|\\(bad\\))")
+            continue()
+        endif()
+        list(APPEND insns_${nfunctions} "${insn}")
+    endif()
+endforeach()
+
+file(STRINGS ${SOURCE} annotations REGEX "// codegen: ")
+if(NOT annotations)
+    message(FATAL_ERROR "No '// codegen:' annotations in ${SOURCE}")
+endif()
+
+set(failures "")
+foreach(annotation IN LISTS annotations)
+    if(NOT annotation MATCHES "// codegen: ([^ ]+) ([a-z_]+)( ([0-9]+))?$")
+        message(FATAL_ERROR "Bad annotation: ${annotation}")
+    endif()
+    set(pattern "${CMAKE_MATCH_1}")
+    set(kind "${CMAKE_MATCH_2}")
+    set(max 4)
+    if(CMAKE_MATCH_4)
+        set(max ${CMAKE_MATCH_4})
+    endif()
+
+    set(found FALSE)
+    foreach(n RANGE 1 ${nfunctions})
+        if(NOT name_${n} MATCHES "^${pattern}$")
+            continue()
+        endif()
+        set(found TRUE)
+        set(insns "${insns_${n}}")
+        list(LENGTH insns count)
+        set(ok TRUE)
+        if(kind STREQUAL "indirect_tail_call")
+            set(last_ok "${indirect_jump}")
+            set(body_bad "${bad}")
+        elseif(kind STREQUAL "direct_tail_call")
+            set(last_ok "${direct_jump}")
+            set(body_bad "${bad}")
+        elseif(kind STREQUAL "inlined")
+            set(last_ok "${return}")
+            set(body_bad "${bad_inlined}")
+        else()
+            message(FATAL_ERROR "Unknown kind '${kind}' in: ${annotation}")
+        endif()
+        if(count GREATER max OR count EQUAL 0)
+            set(ok FALSE)
+        else()
+            math(EXPR last "${count} - 1")
+            list(GET insns ${last} final)
+            if(NOT final MATCHES "${last_ok}")
+                set(ok FALSE)
+            endif()
+            list(REMOVE_AT insns ${last})
+            foreach(insn IN LISTS insns)
+                if(insn MATCHES "${body_bad}" OR insn MATCHES "${branch}"
+                   OR insn MATCHES "${return}")
+                    set(ok FALSE)
+                endif()
+            endforeach()
+        endif()
+
+        string(REPLACE ";" "\n    " listing "${insns_${n}}")
+        if(ok)
+            message("ok ${kind}: ${name_${n}}")
+        else()
+            string(APPEND failures
+                   "${name_${n}} is not ${kind} (${arch}):\n    ${listing}\n")
+        endif()
+    endforeach()
+    if(NOT found)
+        string(APPEND failures "No function matching '${pattern}'\n")
+    endif()
+endforeach()
+
+if(failures)
+    message(FATAL_ERROR "${failures}")
+endif()
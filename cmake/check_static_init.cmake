@@ -0,0 +1,31 @@
+# check_static_init.cmake
+#
+# Fail if a binary has static init functions, i.e. namespace scope objects
+# initialized at run time.
+#
+# Run as: cmake -DNM=<nm> -DBINARY=<file> -P check_static_init.cmake
+
+cmake_minimum_required(VERSION 3.4)
+
+if(NOT NM OR NOT BINARY)
+    message(FATAL_ERROR "Usage: cmake -DNM=<nm> -DBINARY=<file> -P check_static_init.cmake")
+endif()
+
+execute_process(
+    COMMAND ${NM} ${BINARY}
+    OUTPUT_VARIABLE symbols
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${NM} failed on ${BINARY}")
+endif()
+
+# GCC and clang name the initialization functions of a translation unit
+# _GLOBAL__sub_I_<file> and __static_initialization_and_destruction_0.
+string(REGEX MATCHALL "[^\n]*(_GLOBAL__sub_I_|__static_initialization_and_destruction)[^\n]*"
+       found "${symbols}")
+if(found)
+    string(REPLACE ";" "\n" found "${found}")
+    message(FATAL_ERROR "Dynamic initialization in ${BINARY}:\n${found}")
+endif()
+message("No dynamic initialization in ${BINARY}")
@@ -0,0 +1,97 @@
+# codesize_report.cmake
+#
+# Report the .text size and number of instantiations of each delegate
+# trampoline kind (doNullCB, doMemberCB, doFunctor, ...) in a binary.
+#
+# Run as: cmake -DNM=<nm> -DBINARY=<file> -P codesize_report.cmake
+#
+# Instantiations folded by the linker (identical code folding) share one
+# address. They are counted as instantiations but only once in 'bodies' and
+# 'bytes'.
+
+cmake_minimum_required(VERSION 3.4)
+
+if(NOT NM OR NOT BINARY)
+    message(FATAL_ERROR "Usage: cmake -DNM=<nm> -DBINARY=<file> -P codesize_report.cmake")
+endif()
+
+execute_process(
+    COMMAND ${NM} -C -S --size-sort ${BINARY}
+    OUTPUT_VARIABLE symbols
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${NM} failed on ${BINARY}")
+endif()
+
+# Square brackets, e.g. in '[abi:cxx11]', would stop the list splitting.
+string(REPLACE "[" "(" symbols "${symbols}")
+string(REPLACE "]" ")" symbols "${symbols}")
+string(REPLACE ";" "," symbols "${symbols}")
+string(REPLACE "\n" ";" symbols "${symbols}")
+
+set(kinds "")
+set(listing "")
+foreach(line IN LISTS symbols)
+    if(NOT line MATCHES "^([0-9a-fA-F]+) ([0-9a-fA-F]+) [tTwW] (.*)$")
+        continue()
+    endif()
+    set(addr "${CMAKE_MATCH_1}")
+    set(size "${CMAKE_MATCH_2}")
+    set(name "${CMAKE_MATCH_3}")
+    if(NOT name MATCHES "delegate|common<")
+        continue()
+    endif()
+    if(NOT name MATCHES "::(do[A-Za-z]+)[<(]")
+        continue()
+    endif()
+    set(kind "${CMAKE_MATCH_1}")
+    math(EXPR bytes "0x${size}")
+
+    if(NOT kind IN_LIST kinds)
+        list(APPEND kinds "${kind}")
+        set(count_${kind} 0)
+        set(bytes_${kind} 0)
+        set(addrs_${kind} "")
+    endif()
+    math(EXPR count_${kind} "${count_${kind}} + 1")
+    if(NOT addr IN_LIST addrs_${kind})
+        list(APPEND addrs_${kind} "${addr}")
+        math(EXPR bytes_${kind} "${bytes_${kind}} + ${bytes}")
+    endif()
+    string(APPEND listing "${addr} ${bytes} ${name}\n")
+endforeach()
+
+message("Trampolines in ${BINARY} (address, bytes, symbol):\n${listing}")
+
+function(pad out text width)
+    string(LENGTH "${text}" len)
+    set(result "${text}")
+    while(len LESS width)
+        string(APPEND result " ")
+        math(EXPR len "${len} + 1")
+    endwhile()
+    set(${out} "${result}" PARENT_SCOPE)
+endfunction()
+
+list(SORT kinds)
+set(total_count 0)
+set(total_bodies 0)
+set(total_bytes 0)
+pad(report "kind" 30)
+string(APPEND report "instantiations  bodies  bytes\n")
+foreach(kind IN LISTS kinds)
+    list(LENGTH addrs_${kind} bodies)
+    pad(k "${kind}" 30)
+    pad(c "${count_${kind}}" 16)
+    pad(b "${bodies}" 8)
+    string(APPEND report "${k}${c}${b}${bytes_${kind}}\n")
+    math(EXPR total_count "${total_count} + ${count_${kind}}")
+    math(EXPR total_bodies "${total_bodies} + ${bodies}")
+    math(EXPR total_bytes "${total_bytes} + ${bytes_${kind}}")
+endforeach()
+pad(k "total" 30)
+pad(c "${total_count}" 16)
+pad(b "${total_bodies}" 8)
+string(APPEND report "${k}${c}${b}${total_bytes}")
+message("${report}")
@@ -0,0 +1,183 @@
+/*
+ * arena_delegate.hpp
+ *
+ * Functors stored in a caller supplied monotonic arena, called via a plain
+ * delegate.
+ */
+
+#ifndef DELEGATE_ARENA_DELEGATE_HPP_
+#define DELEGATE_ARENA_DELEGATE_HPP_
+
+/**
+ * A delegate only points to a functor, and inplace_delegate only stores
+ * small trivially copyable ones. For larger closures living for a frame or
+ * a request, 'delegate_arena' hands out storage from a caller supplied
+ * buffer by bumping an offset, and 'arena_delegate' copies the functor
+ * there and returns a delegate to it:
+ *
+ *   alignas(std::max_align_t) unsigned char buf[4096];
+ *   delegate_arena arena(buf);
+ *
+ *   auto d = arena_delegate<void(Reply const&)>(arena, [=](Reply const& r) {
+ *       session->send(requestId, r, headers);
+ *   });
+ *   ...
+ *   arena.reset(); // At request end. All delegates from the arena dangle.
+ *
+ * - The result is a normal two word delegate using the functor trampoline,
+ *   as from 'delegate::make(f)'. No extra indirection at call time.
+ * - Storing a trivially destructible functor is one aligned pointer bump.
+ * - Functors with a non trivial destructor are also linked into a list
+ *   in the arena. 'reset' and the arena destructor run the destructors, in
+ *   reverse order of storing.
+ * - No heap allocation, no exceptions. When the arena is exhausted
+ *   'arena_delegate' returns a null delegate and 'store' a nullptr.
+ *   Functors must be nothrow copy/move constructible.
+ *
+ * Not thread safe. Use one arena per thread or per request.
+ */
+
+#include "delegate.hpp"
+
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+class delegate_arena
+{
+  public:
+    using size_type = details::size_t;
+
+    // Use 'bytes' bytes starting at 'buffer'. The buffer must outlive the
+    // arena.
+    delegate_arena(void* buffer, size_type bytes) noexcept
+        : m_begin(static_cast<unsigned char*>(buffer)), m_capacity(bytes)
+    {
+    }
+
+    template <size_type N>
+    explicit delegate_arena(unsigned char (&buffer)[N]) noexcept
+        : delegate_arena(buffer, N)
+    {
+    }
+
+    delegate_arena(delegate_arena const&) = delete;
+    delegate_arena& operator=(delegate_arena const&) = delete;
+
+    ~delegate_arena()
+    {
+        reset();
+    }
+
+    /**
+     * Move or copy 'f' into the arena. Return a pointer to the stored
+     * functor, or nullptr if there is not room for it.
+     */
+    template <class F>
+    typename std::decay<F>::type* store(F&& f) noexcept
+    {
+        using T = typename std::decay<F>::type;
+        static_assert(std::is_nothrow_constructible<T, F&&>::value,
+                      "delegate_arena require nothrow constructible functors");
+        size_type const mark = m_used;
+        void* obj = allocate(sizeof(T), alignof(T));
+        if (!obj)
+            return nullptr;
+        Destructor* node = nullptr;
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            node = static_cast<Destructor*>(
+                allocate(sizeof(Destructor), alignof(Destructor)));
+            if (!node)
+            {
+                m_used = mark;
+                return nullptr;
+            }
+        }
+        T* res = ::new (obj) T(std::forward<F>(f));
+        if (node)
+        {
+            node->destroy = &destroy<T>;
+            node->obj = res;
+            node->prev = m_destructors;
+            m_destructors = node;
+        }
+        return res;
+    }
+
+    /**
+     * Destroy all stored functors with a non trivial destructor and make the
+     * whole buffer available again. All delegates to functors in the arena
+     * are invalid afterwards.
+     */
+    void reset() noexcept
+    {
+        while (m_destructors)
+        {
+            m_destructors->destroy(m_destructors->obj);
+            m_destructors = m_destructors->prev;
+        }
+        m_used = 0;
+    }
+
+    // Bytes handed out since the last reset, including alignment padding.
+    size_type used() const noexcept
+    {
+        return m_used;
+    }
+    size_type capacity() const noexcept
+    {
+        return m_capacity;
+    }
+    size_type remaining() const noexcept
+    {
+        return m_capacity - m_used;
+    }
+
+  private:
+    struct Destructor
+    {
+        void (*destroy)(void*);
+        void* obj;
+        Destructor* prev;
+    };
+
+    template <class T>
+    static void destroy(void* obj) noexcept
+    {
+        static_cast<T*>(obj)->~T();
+    }
+
+    void* allocate(size_type bytes, size_type align) noexcept
+    {
+        auto const addr =
+            reinterpret_cast<std::uintptr_t>(m_begin + m_used);
+        size_type const pad = static_cast<size_type>(-addr & (align - 1));
+        if (pad > m_capacity - m_used || bytes > m_capacity - m_used - pad)
+            return nullptr;
+        void* res = m_begin + m_used + pad;
+        m_used += pad + bytes;
+        return res;
+    }
+
+    unsigned char* m_begin;
+    size_type m_capacity;
+    size_type m_used = 0;
+    Destructor* m_destructors = nullptr;
+};
+
+/**
+ * Store 'f' in 'arena' and return a delegate calling it. Returns a null
+ * delegate if the arena is full. The delegate is valid until the arena is
+ * reset or destroyed.
+ */
+template <typename Signature, class F>
+delegate<Signature>
+arena_delegate(delegate_arena& arena, F&& f) noexcept
+{
+    auto p = arena.store(std::forward<F>(f));
+    return p ? delegate<Signature>::make(*p) : delegate<Signature>{};
+}
+
+#endif /* DELEGATE_ARENA_DELEGATE_HPP_ */
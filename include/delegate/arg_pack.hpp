@@ -0,0 +1,121 @@
+/*
+ * arg_pack.hpp
+ *
+ * Inline storage of argument values for the headers building on delegate.
+ */
+
+#ifndef DELEGATE_ARG_PACK_HPP_
+#define DELEGATE_ARG_PACK_HPP_
+
+/**
+ * A minimal tuple. Unlike std::tuple it is an aggregate, hence trivially
+ * copyable when all the stored types are. Used where argument values are
+ * stored next to a delegate, e.g. delegate_queue and bound_delegate.
+ */
+
+#include "delegate.hpp"
+
+#include <type_traits>
+
+namespace details
+{
+
+template <typename... T>
+struct arg_pack
+{
+};
+template <typename T, typename... Rest>
+struct arg_pack<T, Rest...>
+{
+    T head;
+    arg_pack<Rest...> tail;
+};
+
+constexpr arg_pack<>
+makePack()
+{
+    return arg_pack<>{};
+}
+template <typename T, typename... Rest>
+constexpr arg_pack<T, Rest...>
+makePack(T const& t, Rest const&... rest)
+{
+    return arg_pack<T, Rest...>{t, makePack(rest...)};
+}
+
+// Call d(stored values...).
+template <typename D, typename... Got>
+void
+callWithPack(D const& d, arg_pack<> const&, Got const&... got)
+{
+    d(got...);
+}
+template <typename D, typename T, typename... Rest, typename... Got>
+void
+callWithPack(D const& d, arg_pack<T, Rest...> const& p, Got const&... got)
+{
+    callWithPack(d, p.tail, got..., p.head);
+}
+
+// Access to element I.
+template <size_t I, typename P>
+struct pack_element;
+template <typename T, typename... Rest>
+struct pack_element<0, arg_pack<T, Rest...>>
+{
+    using type = T;
+    static constexpr T const& get(arg_pack<T, Rest...> const& p) noexcept
+    {
+        return p.head;
+    }
+};
+template <size_t I, typename T, typename... Rest>
+struct pack_element<I, arg_pack<T, Rest...>>
+{
+    using Next = pack_element<I - 1, arg_pack<Rest...>>;
+    using type = typename Next::type;
+    static constexpr type const& get(arg_pack<T, Rest...> const& p) noexcept
+    {
+        return Next::get(p.tail);
+    }
+};
+
+template <size_t I, typename... T>
+constexpr typename pack_element<I, arg_pack<T...>>::type const&
+packGet(arg_pack<T...> const& p) noexcept
+{
+    return pack_element<I, arg_pack<T...>>::get(p);
+}
+
+// Same as std::index_sequence, which is C++14.
+template <size_t... I>
+struct index_seq
+{
+};
+template <size_t N, size_t... I>
+struct make_index_seq : make_index_seq<N - 1, N - 1, I...>
+{
+};
+template <size_t... I>
+struct make_index_seq<0, I...>
+{
+    using type = index_seq<I...>;
+};
+
+template <typename T>
+struct all_trivially_copyable;
+template <>
+struct all_trivially_copyable<arg_pack<>> : std::true_type
+{
+};
+template <typename T, typename... Rest>
+struct all_trivially_copyable<arg_pack<T, Rest...>>
+    : std::integral_constant<
+          bool, std::is_trivially_copyable<T>::value &&
+                    all_trivially_copyable<arg_pack<Rest...>>::value>
+{
+};
+
+} // namespace details
+
+#endif /* DELEGATE_ARG_PACK_HPP_ */
@@ -0,0 +1,330 @@
+/*
+ * atomic_delegate.hpp
+ *
+ * Delegate which can be replaced by one thread while others call it.
+ */
+
+#ifndef DELEGATE_ATOMIC_DELEGATE_HPP_
+#define DELEGATE_ATOMIC_DELEGATE_HPP_
+
+/**
+ * A delegate is 2 pointers, the trampoline and the data pointer. Setting
+ * one while another thread calls it can give a torn read, calling the new
+ * trampoline with the old data pointer. atomic_delegate guarantees that a
+ * load always see a trampoline/data pair which was stored together.
+ *
+ * Two storage implementations exist:
+ * - details::dwcas_atomic_storage : Require a double pointer width compare
+ *   and swap (e.g. x86-64 compiled with -mcx16, AArch64). Lock-free for
+ *   all operations. Stores use compare and swap. With a double width
+ *   atomic plain load (x86-64 compiled with -mavx, where an aligned 16 byte
+ *   'vmovdqa' is atomic) a load is one instruction which writes nothing,
+ *   wait-free. Otherwise a load is a compare and swap, which takes the
+ *   cache line exclusively and so serializes concurrent readers.
+ * - details::versioned_atomic_storage : Double buffered slots with a
+ *   version counter. Load only does plain loads, so it scales well with
+ *   many readers. A load is retried only if a store completed while it was
+ *   reading. A load which interrupts a store (e.g. from an ISR) is never
+ *   retried. Stores are serialized by a spin lock. The load is lock-free
+ *   but not wait-free: stores completing back to back can keep a reader
+ *   retrying.
+ *
+ * The default storage is picked at compile time: dwcas_atomic_storage when
+ * it has the plain atomic load, else versioned_atomic_storage, so loads
+ * never write to the shared line. Define DELEGATE_ATOMIC_NO_DWCAS to
+ * always use the versioned storage. 'is_load_wait_free' tells if the load
+ * of the chosen storage is wait-free.
+ *
+ * As for delegate, no heap allocation and no exceptions.
+ */
+
+#include "delegate.hpp"
+#include "delegate_words.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace details
+{
+
+#if (defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16) && UINTPTR_MAX > 0xffffffff)
+__extension__ typedef unsigned __int128 dwcas_word_type;
+#define DELEGATE_HAVE_DWCAS 1
+#elif (defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8) && UINTPTR_MAX == 0xffffffff)
+typedef std::uint64_t dwcas_word_type;
+#define DELEGATE_HAVE_DWCAS 1
+#endif
+
+// Processors supporting AVX guarantee that aligned 16 byte vector loads
+// are atomic (Intel SDM vol. 3A 9.1.1, AMD APM vol. 2 7.3.2).
+#if defined(DELEGATE_HAVE_DWCAS) && defined(__x86_64__) && defined(__AVX__)
+#define DELEGATE_HAVE_DWLOAD 1
+#endif
+
+#ifdef DELEGATE_HAVE_DWCAS
+/**
+ * Store both words in one double width integer. Written only with compare
+ * and swap, read with a plain atomic load when DELEGATE_HAVE_DWLOAD.
+ */
+class dwcas_atomic_storage
+{
+  public:
+    explicit dwcas_atomic_storage(delegate_words w) noexcept
+        : m_value(pack(w))
+    {
+    }
+
+    static constexpr bool is_always_lock_free = true;
+    // One instruction, never retried.
+    static constexpr bool is_load_wait_free = true;
+
+    delegate_words load() const noexcept
+    {
+#ifdef DELEGATE_HAVE_DWLOAD
+        // One aligned 16 byte load. Asm, so it is never split in two. As
+        // all x86 loads it has acquire semantics.
+        __m128i v;
+        __asm__ __volatile__("vmovdqa %1, %0"
+                             : "=x"(v)
+                             : "m"(m_value)
+                             : "memory");
+        delegate_words w;
+        std::memcpy(&w, &v, sizeof w);
+        return w;
+#else
+        // A failing CAS is an atomic read, but it writes the cache line.
+        // Stored value is never 0 since the trampoline pointer never is
+        // null.
+        return unpack(__sync_val_compare_and_swap(&m_value, 0, 0));
+#endif
+    }
+
+    delegate_words exchange(delegate_words desired) noexcept
+    {
+        dwcas_word_type d = pack(desired);
+        dwcas_word_type old = pack(load());
+        for (;;)
+        {
+            dwcas_word_type prev = __sync_val_compare_and_swap(&m_value, old, d);
+            if (prev == old)
+                return unpack(prev);
+            old = prev;
+        }
+    }
+
+    bool compare_exchange(delegate_words& expected,
+                          delegate_words desired) noexcept
+    {
+        dwcas_word_type e = pack(expected);
+        dwcas_word_type prev =
+            __sync_val_compare_and_swap(&m_value, e, pack(desired));
+        if (prev == e)
+            return true;
+        expected = unpack(prev);
+        return false;
+    }
+
+  private:
+    static dwcas_word_type pack(delegate_words w) noexcept
+    {
+        dwcas_word_type v;
+        std::memcpy(&v, &w, sizeof v);
+        return v;
+    }
+    static delegate_words unpack(dwcas_word_type v) noexcept
+    {
+        delegate_words w;
+        std::memcpy(&w, &v, sizeof w);
+        return w;
+    }
+
+    alignas(sizeof(dwcas_word_type)) mutable dwcas_word_type m_value;
+};
+#endif
+
+/**
+ * Fallback without double width CAS. Two slots, the version counter select
+ * the current one. A store write the other slot and then publish it by
+ * incrementing the version. A load read the current slot and check that
+ * the version did not change meanwhile.
+ */
+class versioned_atomic_storage
+{
+  public:
+    explicit versioned_atomic_storage(delegate_words w) noexcept
+    {
+        write(0, w);
+    }
+
+    static constexpr bool is_always_lock_free = false;
+    // Retried while stores complete during the load.
+    static constexpr bool is_load_wait_free = false;
+
+    delegate_words load() const noexcept
+    {
+        for (;;)
+        {
+            unsigned v = m_version.load(std::memory_order_acquire);
+            delegate_words w = read(v & 1u);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_version.load(std::memory_order_relaxed) == v)
+                return w;
+        }
+    }
+
+    delegate_words exchange(delegate_words desired) noexcept
+    {
+        lock();
+        unsigned v = m_version.load(std::memory_order_relaxed);
+        delegate_words old = read(v & 1u);
+        publish(v, desired);
+        unlock();
+        return old;
+    }
+
+    bool compare_exchange(delegate_words& expected,
+                          delegate_words desired) noexcept
+    {
+        lock();
+        unsigned v = m_version.load(std::memory_order_relaxed);
+        delegate_words old = read(v & 1u);
+        bool const eq = old.w[0] == expected.w[0] && old.w[1] == expected.w[1];
+        if (eq)
+            publish(v, desired);
+        else
+            expected = old;
+        unlock();
+        return eq;
+    }
+
+  private:
+    void publish(unsigned v, delegate_words w) noexcept
+    {
+        // Make sure a reader seeing any of the writes below also see the
+        // version published before them.
+        std::atomic_thread_fence(std::memory_order_release);
+        write((v + 1) & 1u, w);
+        m_version.store(v + 1, std::memory_order_release);
+    }
+
+    delegate_words read(unsigned slot) const noexcept
+    {
+        delegate_words w;
+        w.w[0] = m_slots[slot][0].load(std::memory_order_relaxed);
+        w.w[1] = m_slots[slot][1].load(std::memory_order_relaxed);
+        return w;
+    }
+    void write(unsigned slot, delegate_words w) noexcept
+    {
+        m_slots[slot][0].store(w.w[0], std::memory_order_relaxed);
+        m_slots[slot][1].store(w.w[1], std::memory_order_relaxed);
+    }
+
+    void lock() noexcept
+    {
+        while (m_lock.exchange(true, std::memory_order_acquire))
+        {
+        }
+    }
+    void unlock() noexcept
+    {
+        m_lock.store(false, std::memory_order_release);
+    }
+
+    std::atomic<unsigned> m_version{0};
+    std::atomic<bool> m_lock{false};
+    std::atomic<std::uintptr_t> m_slots[2][2];
+};
+
+#if defined(DELEGATE_HAVE_DWLOAD) && !defined(DELEGATE_ATOMIC_NO_DWCAS)
+using default_atomic_storage = dwcas_atomic_storage;
+#else
+using default_atomic_storage = versioned_atomic_storage;
+#endif
+
+} // namespace details
+
+template <typename Signature,
+          typename Storage = details::default_atomic_storage>
+class atomic_delegate;
+
+/**
+ * Atomic wrapper for delegate<R(Args...)>, similar to std::atomic.
+ *
+ * @param R type of the return value from calling the callback.
+ * @param Args Argument list to the function when calling the callback.
+ * @param Storage Implementation, see top of file.
+ */
+template <typename R, typename... Args, typename Storage>
+class atomic_delegate<R(Args...), Storage>
+{
+  public:
+    using Delegate = delegate<R(Args...)>;
+
+    static constexpr bool is_always_lock_free = Storage::is_always_lock_free;
+    static constexpr bool is_load_wait_free = Storage::is_load_wait_free;
+
+    // Default construct to the null delegate.
+    atomic_delegate() noexcept : m_store(details::toWords(Delegate{})) {}
+    atomic_delegate(Delegate d) noexcept : m_store(details::toWords(d)) {}
+
+    atomic_delegate(atomic_delegate const&) = delete;
+    atomic_delegate& operator=(atomic_delegate const&) = delete;
+
+    atomic_delegate& operator=(Delegate d) noexcept
+    {
+        store(d);
+        return *this;
+    }
+
+    Delegate load() const noexcept
+    {
+        return details::fromWords<Delegate>(m_store.load());
+    }
+
+    operator Delegate() const noexcept
+    {
+        return load();
+    }
+
+    void store(Delegate d) noexcept
+    {
+        exchange(d);
+    }
+
+    Delegate exchange(Delegate d) noexcept
+    {
+        return details::fromWords<Delegate>(
+            m_store.exchange(details::toWords(d)));
+    }
+
+    /**
+     * Set to 'desired' if the current value is bitwise equal to 'expected'.
+     * Otherwise 'expected' is updated with the current value.
+     * Return true if 'desired' was stored.
+     */
+    bool compare_exchange(Delegate& expected, Delegate desired) noexcept
+    {
+        details::delegate_words e = details::toWords(expected);
+        bool res = m_store.compare_exchange(e, details::toWords(desired));
+        if (!res)
+            expected = details::fromWords<Delegate>(e);
+        return res;
+    }
+
+    // Load the current delegate and call it.
+    R operator()(Args... args) const
+    {
+        return load()(details::fwd<Args>(args)...);
+    }
+
+  private:
+    Storage m_store;
+};
+
+#endif /* DELEGATE_ATOMIC_DELEGATE_HPP_ */
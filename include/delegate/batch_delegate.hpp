@@ -0,0 +1,273 @@
+/*
+ * batch_delegate.hpp
+ *
+ * Delegate called once per batch of elements, looping inside the trampoline.
+ */
+
+#ifndef DELEGATE_BATCH_DELEGATE_HPP_
+#define DELEGATE_BATCH_DELEGATE_HPP_
+
+/**
+ * Calling a delegate<void(Sample const&)> for each element of a buffer
+ * costs one indirect call per element, and the target can not be inlined
+ * into the loop. A batch_delegate<void(Sample const&)> is bound to the same
+ * per element target, but is called with the whole buffer:
+ *
+ *   auto d = batch_delegate<void(Sample const&)>::make<Filter,
+ *                                                      &Filter::add>(f);
+ *   d(samples.data(), samples.size()); // f.add(s) for each sample
+ *   d(samples);                        // Same, any range with data/size
+ *
+ * The loop is part of the trampoline, instantiated where 'make' is called.
+ * The target is inlined into the loop and can be vectorized, leaving one
+ * indirect call per batch.
+ *
+ * Elements taken by non-const reference, 'void(Sample&)', are passed as
+ * 'Sample*' and can be modified. Otherwise the elements are passed as
+ * 'Sample const*'. Rvalue reference elements, 'void(Sample&&)', are
+ * rejected by a static_assert.
+ *
+ * Two words and trivially copyable. 'batch()' return the underlying
+ * delegate<void(Sample const*, size_t)>.
+ */
+
+#include "delegate.hpp"
+
+#include <type_traits>
+
+namespace details
+{
+
+// Pointer to the elements for a per element parameter of type E.
+template <typename E>
+struct batch_pointer
+{
+    using type = typename std::remove_cv<E>::type const*;
+};
+template <typename E>
+struct batch_pointer<E&>
+{
+    using type = E*;
+};
+// Not supported, see batch_delegate. Only keeps the errors to the
+// static_assert.
+template <typename E>
+struct batch_pointer<E&&>
+{
+    using type = typename std::remove_cv<E>::type const*;
+};
+
+} // namespace details
+
+template <typename Signature>
+class batch_delegate;
+
+/**
+ * @param E Parameter type of the per element target.
+ */
+template <typename E>
+class batch_delegate<void(E)>
+{
+    static_assert(!std::is_rvalue_reference<E>::value,
+                  "batch_delegate elements can not be taken by rvalue "
+                  "reference, take them by value or reference");
+
+  public:
+    using Pointer = typename details::batch_pointer<E>::type;
+    using Delegate = delegate<void(Pointer, details::size_t)>;
+    using DataPtr = typename Delegate::DataPtr;
+    using Trampoline = typename Delegate::Trampoline;
+
+  private:
+    template <class T, void (T::*mf)(E)>
+    static void doMember(DataPtr o, Pointer first, details::size_t n)
+    {
+        T* obj = static_cast<T*>(o.ptr());
+        for (details::size_t i = 0; i != n; ++i)
+            (obj->*mf)(first[i]);
+    }
+
+    template <class T, void (T::*mf)(E) const>
+    static void doConstMember(DataPtr o, Pointer first, details::size_t n)
+    {
+        T const* obj = static_cast<T const*>(o.ptr());
+        for (details::size_t i = 0; i != n; ++i)
+            (obj->*mf)(first[i]);
+    }
+
+    template <void (*fkn)(E)>
+    static void doFree(DataPtr, Pointer first, details::size_t n)
+    {
+        for (details::size_t i = 0; i != n; ++i)
+            fkn(first[i]);
+    }
+
+    template <typename F>
+    static void doFunctor(DataPtr o, Pointer first, details::size_t n)
+    {
+        F& f = *static_cast<F*>(o.ptr());
+        for (details::size_t i = 0; i != n; ++i)
+            f(first[i]);
+    }
+
+    constexpr batch_delegate(Trampoline fkn, void* obj) noexcept
+        : m_del(fkn, obj)
+    {
+    }
+
+  public:
+    // Default construct to null state.
+    constexpr batch_delegate() = default;
+    constexpr batch_delegate(details::nullptr_t) noexcept {}
+
+    // Call member function 'mf' on 'obj' for each element.
+    template <class T, void (T::*mf)(E)>
+    static constexpr batch_delegate make(T& obj) noexcept
+    {
+        return batch_delegate{&doMember<T, mf>, static_cast<void*>(&obj)};
+    }
+
+    template <class T, void (T::*mf)(E) const>
+    static constexpr batch_delegate make(T const& obj) noexcept
+    {
+        return batch_delegate{&doConstMember<T, mf>,
+                              const_cast<void*>(static_cast<void const*>(&obj))};
+    }
+
+    // Delete r-values. Not interested in temporaries.
+    template <class T, void (T::*mf)(E)>
+    static batch_delegate make(T&&) = delete;
+    template <class T, void (T::*mf)(E) const>
+    static batch_delegate make(T&&) = delete;
+
+    // Call free function 'fkn' for each element.
+    template <void (*fkn)(E)>
+    static constexpr batch_delegate make() noexcept
+    {
+        return batch_delegate{&doFree<fkn>, nullptr};
+    }
+
+    /**
+     * Call the functor 'f' for each element, e.g. a lambda. Must outlive the
+     * batch_delegate. A per element delegate<void(E)> is also a functor, to
+     * adapt an existing delegate. Its target is then called indirectly.
+     */
+    template <typename F>
+    static constexpr batch_delegate make(F& f) noexcept
+    {
+        return batch_delegate{
+            &doFunctor<F>,
+            const_cast<void*>(static_cast<void const*>(&f))};
+    }
+
+    template <typename F>
+    static batch_delegate make(F const&&) = delete;
+
+#if DELEGATE_CPP_VERSION >= 201703L
+    // Deduce the object type of member function 'mf'.
+    template <auto mf, class T>
+    static constexpr batch_delegate make(T& obj) noexcept
+    {
+        return make<std::remove_const_t<T>, mf>(obj);
+    }
+    template <auto mf, class T>
+    static batch_delegate make(T&&) = delete;
+#endif
+
+    // Call the target for elements [first, first + n). Valid to call in
+    // null state.
+    DELEGATE_ALWAYS_INLINE void operator()(Pointer first,
+                                           details::size_t n) const
+    {
+        m_del(first, n);
+    }
+
+    // Call the target for each element of a range with data() and size(),
+    // e.g. std::vector, std::array or std::span.
+    template <typename Range>
+    DELEGATE_ALWAYS_INLINE auto operator()(Range&& r) const
+        -> decltype(void(Pointer{r.data()}), void(r.size()))
+    {
+        m_del(r.data(), r.size());
+    }
+
+    template <details::size_t N>
+    DELEGATE_ALWAYS_INLINE void
+    operator()(typename std::remove_pointer<Pointer>::type (&arr)[N]) const
+    {
+        m_del(arr, N);
+    }
+
+    // The delegate called with each batch.
+    constexpr Delegate const& batch() const noexcept
+    {
+        return m_del;
+    }
+
+    constexpr bool null() const noexcept
+    {
+        return m_del.null();
+    }
+    constexpr explicit operator bool() const noexcept
+    {
+        return !null();
+    }
+
+    DELEGATE_CXX14CONSTEXPR void clear() noexcept
+    {
+        m_del.clear();
+    }
+
+    static constexpr bool equal(batch_delegate const& lhs,
+                                batch_delegate const& rhs) noexcept
+    {
+        return lhs.m_del == rhs.m_del;
+    }
+
+  private:
+    Delegate m_del;
+};
+
+template <typename S>
+constexpr bool
+operator==(batch_delegate<S> const& lhs, batch_delegate<S> const& rhs) noexcept
+{
+    return batch_delegate<S>::equal(lhs, rhs);
+}
+
+template <typename S>
+constexpr bool
+operator!=(batch_delegate<S> const& lhs, batch_delegate<S> const& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+template <typename S>
+constexpr bool
+operator==(batch_delegate<S> const& lhs, details::nullptr_t) noexcept
+{
+    return lhs.null();
+}
+
+template <typename S>
+constexpr bool
+operator==(details::nullptr_t, batch_delegate<S> const& rhs) noexcept
+{
+    return rhs.null();
+}
+
+template <typename S>
+constexpr bool
+operator!=(batch_delegate<S> const& lhs, details::nullptr_t) noexcept
+{
+    return !lhs.null();
+}
+
+template <typename S>
+constexpr bool
+operator!=(details::nullptr_t, batch_delegate<S> const& rhs) noexcept
+{
+    return !rhs.null();
+}
+
+#endif /* DELEGATE_BATCH_DELEGATE_HPP_ */
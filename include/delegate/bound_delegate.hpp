@@ -0,0 +1,289 @@
+/*
+ * bound_delegate.hpp
+ *
+ * Delegate with leading arguments bound to stored values.
+ */
+
+#ifndef DELEGATE_BOUND_DELEGATE_HPP_
+#define DELEGATE_BOUND_DELEGATE_HPP_
+
+/**
+ * Similar to std::bind_front. A bound_delegate<R(Args...), Bound...> calls
+ * a function taking (Bound..., Args...), prepending the stored values of
+ * the bound arguments. E.g. binding a connection index to a member
+ * function:
+ *
+ *   struct Server { void onData(int conn, Buffer const& b); };
+ *   auto d = bound_delegate<void(Buffer const&), int>::make<
+ *       Server, &Server::onData>(server, 3);
+ *   d(buf); // server.onData(3, buf)
+ *
+ * With C++17, make_bound deduce the types:
+ *
+ *   auto d = make_bound<&Server::onData>(server, 3);
+ *
+ * The object pointer and the bound values are stored inline, no heap
+ * allocation and no separate functor object. The bound values must be
+ * trivially copyable, so the bound_delegate is trivially copyable.
+ *
+ * The trampoline is called with a data pointer to the internal storage.
+ * As for inplace_delegate, 'view' returns a plain delegate which is valid
+ * as long as the bound_delegate is alive and not modified.
+ */
+
+#include "arg_pack.hpp"
+#include "delegate.hpp"
+
+#include <type_traits>
+
+template <typename Signature, typename... Bound>
+class bound_delegate;
+
+/**
+ * @param R type of the return value from calling the callback.
+ * @param Args Argument list when calling the bound_delegate.
+ * @param Bound Types of the leading, bound, arguments of the target.
+ */
+template <typename R, typename... Args, typename... Bound>
+class bound_delegate<R(Args...), Bound...>
+{
+  public:
+    using Delegate = delegate<R(Args...)>;
+    using common = typename Delegate::common;
+    using DataPtr = typename Delegate::DataPtr;
+    using Trampoline = typename Delegate::Trampoline;
+
+  private:
+    using Pack = details::arg_pack<Bound...>;
+    static_assert(details::all_trivially_copyable<Pack>::value,
+                  "bound_delegate require trivially copyable bound values");
+
+    struct Storage
+    {
+        void* obj;
+        Pack bound;
+    };
+
+    template <typename Seq>
+    struct Invoker;
+
+    template <details::size_t... I>
+    struct Invoker<details::index_seq<I...>>
+    {
+        template <class T, R (T::*mf)(Bound..., Args...)>
+        static R doMember(DataPtr d,
+                          typename Delegate::template Param<Args>... args)
+        {
+            auto s = static_cast<Storage const*>(d.ptr());
+            return (static_cast<T*>(s->obj)->*mf)(
+                details::packGet<I>(s->bound)...,
+                details::fwd<Args>(args)...);
+        }
+
+        template <class T, R (T::*mf)(Bound..., Args...) const>
+        static R doConstMember(DataPtr d,
+                               typename Delegate::template Param<Args>... args)
+        {
+            auto s = static_cast<Storage const*>(d.ptr());
+            return (static_cast<T const*>(s->obj)->*mf)(
+                details::packGet<I>(s->bound)...,
+                details::fwd<Args>(args)...);
+        }
+
+        template <R (*fkn)(Bound..., Args...)>
+        static R doFree(DataPtr d,
+                        typename Delegate::template Param<Args>... args)
+        {
+            auto s = static_cast<Storage const*>(d.ptr());
+            return fkn(details::packGet<I>(s->bound)...,
+                       details::fwd<Args>(args)...);
+        }
+    };
+
+    using Inv =
+        Invoker<typename details::make_index_seq<sizeof...(Bound)>::type>;
+
+    constexpr bound_delegate(Trampoline fkn, void* obj,
+                             Bound const&... b) noexcept
+        : m_fkn(fkn), m_store{obj, details::makePack(b...)}
+    {
+    }
+
+  public:
+    // Default construct to null state.
+    constexpr bound_delegate() = default;
+    constexpr bound_delegate(details::nullptr_t) noexcept {}
+
+    /**
+     * Call member function 'mf' on 'obj', with 'b...' as leading
+     * arguments.
+     */
+    template <class T, R (T::*mf)(Bound..., Args...)>
+    static constexpr bound_delegate make(T& obj, Bound const&... b) noexcept
+    {
+        return bound_delegate{&Inv::template doMember<T, mf>,
+                              static_cast<void*>(&obj), b...};
+    }
+
+    template <class T, R (T::*mf)(Bound..., Args...) const>
+    static constexpr bound_delegate make(T const& obj,
+                                         Bound const&... b) noexcept
+    {
+        return bound_delegate{&Inv::template doConstMember<T, mf>,
+                              const_cast<void*>(static_cast<void const*>(&obj)),
+                              b...};
+    }
+
+    // Delete r-values. Not interested in temporaries.
+    template <class T, R (T::*mf)(Bound..., Args...)>
+    static bound_delegate make(T&&, Bound const&...) = delete;
+    template <class T, R (T::*mf)(Bound..., Args...) const>
+    static bound_delegate make(T&&, Bound const&...) = delete;
+
+    // Call free function 'fkn' with 'b...' as leading arguments.
+    template <R (*fkn)(Bound..., Args...)>
+    static constexpr bound_delegate make(Bound const&... b) noexcept
+    {
+        return bound_delegate{&Inv::template doFree<fkn>, nullptr, b...};
+    }
+
+    // Call the target. Valid to call in null state.
+    DELEGATE_ALWAYS_INLINE R operator()(Args... args) const
+    {
+        return m_fkn(DataPtr{const_cast<Storage*>(&m_store)},
+                     details::fwd<Args>(args)...);
+    }
+
+    // Return a non owning delegate calling the target with the bound values.
+    Delegate view() const& noexcept
+    {
+        return Delegate{m_fkn, const_cast<Storage*>(&m_store)};
+    }
+    // View of a temporary would dangle.
+    Delegate view() const&& = delete;
+
+    constexpr bool null() const noexcept
+    {
+        return m_fkn == &common::doNullCB;
+    }
+    constexpr explicit operator bool() const noexcept
+    {
+        return !null();
+    }
+
+    DELEGATE_CXX14CONSTEXPR void clear() noexcept
+    {
+        m_fkn = &common::doNullCB;
+    }
+
+  private:
+    Trampoline m_fkn = &common::doNullCB;
+    Storage m_store = {};
+};
+
+template <typename S, typename... B>
+constexpr bool
+operator==(bound_delegate<S, B...> const& lhs, details::nullptr_t) noexcept
+{
+    return lhs.null();
+}
+
+template <typename S, typename... B>
+constexpr bool
+operator==(details::nullptr_t, bound_delegate<S, B...> const& rhs) noexcept
+{
+    return rhs.null();
+}
+
+template <typename S, typename... B>
+constexpr bool
+operator!=(bound_delegate<S, B...> const& lhs, details::nullptr_t) noexcept
+{
+    return !lhs.null();
+}
+
+template <typename S, typename... B>
+constexpr bool
+operator!=(details::nullptr_t, bound_delegate<S, B...> const& rhs) noexcept
+{
+    return !rhs.null();
+}
+
+#if DELEGATE_CPP_VERSION >= 201703L
+
+namespace details
+{
+
+template <typename... T>
+struct type_list
+{
+};
+
+// Split a type_list after the first N types.
+template <size_t N, typename Front, typename Back, bool = N == 0>
+struct split_list;
+template <size_t N, typename Front, typename Back>
+struct split_list<N, Front, Back, true>
+{
+    using front = Front;
+    using back = Back;
+};
+template <size_t N, typename... F, typename H, typename... B>
+struct split_list<N, type_list<F...>, type_list<H, B...>, false>
+    : split_list<N - 1, type_list<F..., H>, type_list<B...>>
+{
+};
+
+template <typename R, typename Front, typename Back>
+struct bound_type;
+template <typename R, typename... F, typename... B>
+struct bound_type<R, type_list<F...>, type_list<B...>>
+{
+    using type = bound_delegate<R(B...), F...>;
+};
+
+template <typename M>
+struct bound_member;
+template <typename T, typename R, typename... P, bool ne>
+struct bound_member<R (T::*)(P...) noexcept(ne)>
+{
+    using ObjType = T;
+    using Ret = R;
+    using Params = type_list<P...>;
+};
+template <typename T, typename R, typename... P, bool ne>
+struct bound_member<R (T::*)(P...) const noexcept(ne)>
+{
+    using ObjType = T const;
+    using Ret = R;
+    using Params = type_list<P...>;
+};
+
+template <auto mf, size_t nBound>
+using bound_member_t = typename bound_type<
+    typename bound_member<decltype(mf)>::Ret,
+    typename split_list<nBound, type_list<>,
+                        typename bound_member<decltype(mf)>::Params>::front,
+    typename split_list<nBound, type_list<>,
+                        typename bound_member<decltype(mf)>::Params>::back>::
+    type;
+
+} // namespace details
+
+/**
+ * Bind the leading arguments of member function 'mf' on 'obj' to 'b...'.
+ * The remaining arguments of 'mf' are the arguments of the bound_delegate.
+ */
+template <auto mf, typename... B>
+constexpr details::bound_member_t<mf, sizeof...(B)>
+make_bound(typename details::bound_member<decltype(mf)>::ObjType& obj,
+           B const&... b) noexcept
+{
+    using BD = details::bound_member_t<mf, sizeof...(B)>;
+    using T = typename details::bound_member<decltype(mf)>::ObjType;
+    return BD::template make<std::remove_const_t<T>, mf>(obj, b...);
+}
+
+#endif
+
+#endif /* DELEGATE_BOUND_DELEGATE_HPP_ */
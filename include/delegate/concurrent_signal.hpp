@@ -0,0 +1,305 @@
+/*
+ * concurrent_signal.hpp
+ *
+ * Multicast delegate emitted from many threads while listeners rarely
+ * change.
+ */
+
+#ifndef DELEGATE_CONCURRENT_SIGNAL_HPP_
+#define DELEGATE_CONCURRENT_SIGNAL_HPP_
+
+/**
+ * A multicast_delegate protected by a mutex serializes all emitting
+ * threads on the mutex. In a concurrent_signal the emitters instead read
+ * an immutable snapshot of the listener list, a multicast_delegate in its
+ * own cache line. Subscribe and unsubscribe copy the current snapshot,
+ * modify the copy and publish it with one atomic store (copy on write, as
+ * in RCU).
+ *
+ * Each emitting thread first claims an emitter, which owns a hazard
+ * pointer slot in its own cache line:
+ *
+ *   concurrent_signal<void(Quote const&), 16> sig;
+ *   sig.subscribe(delegate<void(Quote const&)>::make<Book, &Book::onQuote>(b));
+ *   ...
+ *   auto emitter = sig.get_emitter(); // Once per thread.
+ *   emitter(quote);                   // Calls all listeners.
+ *
+ * An emit loads the current snapshot (acquire), publishes it in the
+ * emitter's hazard slot and checks that it is still current. It then calls
+ * the listeners and clears the slot. There are no writes to shared cache
+ * lines, so emit throughput scales with the number of cores. The store to
+ * the hazard slot is sequentially consistent, the only fence on the emit
+ * path.
+ *
+ * Properties:
+ * - No heap allocation. The snapshots come from a fixed pool of
+ *   Emitters + 2. A snapshot is reused when it is not current and no
+ *   emitter's hazard slot holds it. With at most one snapshot held per
+ *   emitter, a free snapshot always exists.
+ * - No exceptions. 'subscribe' return false when N listeners are stored,
+ *   'get_emitter' return an invalid emitter when all Emitters are claimed.
+ *   Calling an invalid emitter does nothing.
+ * - Subscribe/unsubscribe are serialized by a mutex, never taken by emit.
+ * - An emit started before 'unsubscribe' returned may still call the
+ *   removed listener. 'synchronize' waits until such emits are done, e.g.
+ *   before destroying the listener.
+ * - Listeners may not subscribe/unsubscribe on the signal they are
+ *   called from, or call 'synchronize'.
+ */
+
+#include "delegate.hpp"
+#include "multicast_delegate.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+template <typename Signature, details::size_t N,
+          details::size_t Emitters = 64>
+class concurrent_signal;
+
+/**
+ * @param Args Argument list to the function when calling the listeners.
+ * @param N Maximum number of listeners.
+ * @param Emitters Maximum number of emitters claimed at the same time.
+ */
+template <typename... Args, details::size_t N, details::size_t Emitters>
+class concurrent_signal<void(Args...), N, Emitters>
+{
+  public:
+    using Delegate = delegate<void(Args...)>;
+    using List = multicast_delegate<void(Args...), N>;
+    using size_type = details::size_t;
+
+  private:
+    struct alignas(details::delegate_cache_line) Snapshot
+    {
+        List list;
+    };
+
+    struct alignas(details::delegate_cache_line) HazardSlot
+    {
+        std::atomic<Snapshot const*> hazard{nullptr};
+        std::atomic<bool> claimed{false};
+    };
+
+    static constexpr size_type pool_size = Emitters + 2;
+
+  public:
+    /**
+     * Handle for emitting from one thread. Claims a hazard slot, released
+     * when destroyed. Not to be used by several threads at the same time.
+     */
+    class emitter
+    {
+      public:
+        emitter() = default;
+        emitter(emitter&& o) noexcept : m_sig(o.m_sig), m_slot(o.m_slot)
+        {
+            o.m_sig = nullptr;
+        }
+        emitter& operator=(emitter&& o) noexcept
+        {
+            if (this != &o)
+            {
+                release();
+                m_sig = o.m_sig;
+                m_slot = o.m_slot;
+                o.m_sig = nullptr;
+            }
+            return *this;
+        }
+        ~emitter()
+        {
+            release();
+        }
+
+        /**
+         * Call all listeners of the current snapshot, in storage order.
+         * Does nothing for an invalid emitter.
+         */
+        void operator()(Args... args) const
+        {
+            if (!m_sig)
+                return;
+            m_sig->emit(*m_slot, details::fwd<Args>(args)...);
+        }
+
+        bool valid() const noexcept
+        {
+            return m_sig != nullptr;
+        }
+        explicit operator bool() const noexcept
+        {
+            return valid();
+        }
+
+      private:
+        friend class concurrent_signal;
+
+        emitter(concurrent_signal const* sig, HazardSlot* slot) noexcept
+            : m_sig(sig), m_slot(slot)
+        {
+        }
+
+        void release() noexcept
+        {
+            if (m_sig)
+                m_slot->claimed.store(false, std::memory_order_release);
+            m_sig = nullptr;
+        }
+
+        concurrent_signal const* m_sig = nullptr;
+        HazardSlot* m_slot = nullptr;
+    };
+
+    concurrent_signal() noexcept : m_current(&m_pool[0]) {}
+
+    concurrent_signal(concurrent_signal const&) = delete;
+    concurrent_signal& operator=(concurrent_signal const&) = delete;
+
+    /**
+     * Claim an emitter. Return an invalid emitter if 'Emitters' are
+     * already claimed.
+     */
+    emitter get_emitter() const noexcept
+    {
+        for (auto& slot : m_slots)
+        {
+            if (!slot.claimed.load(std::memory_order_relaxed) &&
+                !slot.claimed.exchange(true, std::memory_order_acquire))
+                return emitter{this, &slot};
+        }
+        return emitter{};
+    }
+
+    /**
+     * Add a listener last. Return false, without storing anything, when
+     * full or if 'del' is null.
+     */
+    bool subscribe(Delegate const& del)
+    {
+        return update([&del](List& l) { return l.add(del); });
+    }
+
+    /**
+     * Remove the first listener comparing equal to 'del'. Return false if
+     * it was not found.
+     */
+    bool unsubscribe(Delegate const& del)
+    {
+        return update([&del](List& l) { return l.remove(del); });
+    }
+
+    void clear()
+    {
+        update([](List& l) {
+            l.clear();
+            return true;
+        });
+    }
+
+    // Wait until emits which may use a replaced snapshot are done.
+    void synchronize() const
+    {
+        for (auto& slot : m_slots)
+        {
+            for (;;)
+            {
+                Snapshot const* h = slot.hazard.load(std::memory_order_seq_cst);
+                // Snapshots published later are also fine.
+                if (h == nullptr ||
+                    h == m_current.load(std::memory_order_seq_cst))
+                    break;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Current listeners. Only stable when not modified concurrently.
+    List const& snapshot() const noexcept
+    {
+        return m_current.load(std::memory_order_acquire)->list;
+    }
+
+    size_type size() const noexcept
+    {
+        return snapshot().size();
+    }
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+    static constexpr size_type capacity() noexcept
+    {
+        return N;
+    }
+
+  private:
+    // Arguments by reference as in the trampolines, not copied again.
+    void emit(HazardSlot& slot, details::param_t<Args>... args) const
+    {
+        Snapshot const* s = m_current.load(std::memory_order_acquire);
+        for (;;)
+        {
+            // The store must be visible before the check below, so a
+            // writer scanning the slots after replacing 's' sees it.
+            slot.hazard.store(s, std::memory_order_seq_cst);
+            Snapshot const* now = m_current.load(std::memory_order_seq_cst);
+            if (now == s)
+                break;
+            s = now;
+        }
+        s->list(details::fwd<Args>(args)...);
+        slot.hazard.store(nullptr, std::memory_order_release);
+    }
+
+    // Copy the current list to a free snapshot, apply 'f' and publish it
+    // if 'f' return true.
+    template <typename F>
+    bool update(F f)
+    {
+        std::lock_guard<std::mutex> lock(m_writeLock);
+        Snapshot* cur = m_current.load(std::memory_order_relaxed);
+        Snapshot* next = freeSnapshot(cur);
+        next->list = cur->list;
+        if (!f(next->list))
+            return false;
+        m_current.store(next, std::memory_order_seq_cst);
+        return true;
+    }
+
+    Snapshot* freeSnapshot(Snapshot const* cur) noexcept
+    {
+        for (;;)
+        {
+            for (auto& s : m_pool)
+            {
+                if (&s != cur && !held(&s))
+                    return &s;
+            }
+            // Hazards can move while scanning, so one emitter may hold
+            // several snapshots during a pass. Rare, retry.
+            std::this_thread::yield();
+        }
+    }
+
+    bool held(Snapshot const* s) const noexcept
+    {
+        for (auto& slot : m_slots)
+        {
+            if (slot.hazard.load(std::memory_order_seq_cst) == s)
+                return true;
+        }
+        return false;
+    }
+
+    // Read by all emitters, written only when a snapshot is published.
+    alignas(details::delegate_cache_line) std::atomic<Snapshot*> m_current;
+    alignas(details::delegate_cache_line) std::mutex m_writeLock;
+    Snapshot m_pool[pool_size];
+    mutable HazardSlot m_slots[Emitters];
+};
+
+#endif /* DELEGATE_CONCURRENT_SIGNAL_HPP_ */
@@ -0,0 +1,184 @@
+/*
+ * coroutine.hpp
+ *
+ * Resume C++20 coroutines through delegates. Require C++20.
+ */
+
+#ifndef DELEGATE_COROUTINE_HPP_
+#define DELEGATE_COROUTINE_HPP_
+
+/**
+ * Let callback based APIs taking a delegate complete a coroutine, without
+ * any heap allocated adapter.
+ *
+ * - resume_delegate(h) : delegate<void()> resuming the coroutine 'h'. The
+ *   trampoline gets the coroutine frame address as data pointer.
+ *
+ * - async_completion<void(Result)>(start) : Awaitable. When awaited it
+ *   calls 'start' with a delegate<void(Result)>. Calling that delegate
+ *   store the result in the awaitable and resume the coroutine. The
+ *   co_await expression returns the result. The awaitable lives in the
+ *   coroutine frame and is the data pointer of the delegate.
+ *
+ *     Result r = co_await async_completion<void(Result)>(
+ *         [&](delegate<void(Result)> done) { io.read(buf, done); });
+ *
+ * The completion delegate must be called exactly once. It may be called
+ * from another thread, or directly from within 'start'. In the latter
+ * case the coroutine continues without being suspended.
+ */
+
+#include "delegate.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#if DELEGATE_CPP_VERSION < 202002L
+#error "delegate coroutine support require at least C++20"
+#endif
+
+namespace details
+{
+
+inline void
+doResume(common<void()>::DataPtr d)
+{
+    std::coroutine_handle<>::from_address(d.ptr()).resume();
+}
+
+/**
+ * State shared by the awaitables. Both 'await_suspend' and the completion
+ * call 'arrive'. The second one to arrive resumes the coroutine.
+ */
+class completion_state
+{
+  protected:
+    // Returns true for the second call.
+    bool arrive() noexcept
+    {
+        return m_arrived.exchange(true, std::memory_order_acq_rel);
+    }
+
+    std::coroutine_handle<> m_handle;
+    std::atomic<bool> m_arrived{false};
+};
+
+} // namespace details
+
+// Return a delegate resuming the coroutine 'h' when called.
+inline delegate<void()>
+resume_delegate(std::coroutine_handle<> h) noexcept
+{
+    return delegate<void()>{&details::doResume, h.address()};
+}
+
+template <typename Signature, typename Start>
+class completion_awaitable;
+
+/**
+ * Awaitable for a completion reporting a 'Result'.
+ * @param Result Argument type of the completion delegate.
+ * @param Start Functor called with the completion delegate.
+ */
+template <typename Result, typename Start>
+class completion_awaitable<void(Result), Start>
+    : private details::completion_state
+{
+  public:
+    using Delegate = delegate<void(Result)>;
+    using value_type = std::decay_t<Result>;
+
+    explicit completion_awaitable(Start start) : m_start(std::move(start)) {}
+
+    completion_awaitable(completion_awaitable const&) = delete;
+    completion_awaitable& operator=(completion_awaitable const&) = delete;
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        m_handle = h;
+        m_start(Delegate{&doComplete, static_cast<void*>(this)});
+        // Completed already, continue without suspending.
+        return !arrive();
+    }
+
+    value_type await_resume()
+    {
+        return std::move(*m_result);
+    }
+
+  private:
+    using Param = typename Delegate::template Param<Result>;
+
+    static void doComplete(typename Delegate::DataPtr d, Param r)
+    {
+        auto* self = static_cast<completion_awaitable*>(d.ptr());
+        self->m_result.emplace(details::fwd<Result>(r));
+        if (self->arrive())
+            self->m_handle.resume();
+    }
+
+    Start m_start;
+    std::optional<value_type> m_result;
+};
+
+/**
+ * Awaitable for a completion without result.
+ * @param Start Functor called with the completion delegate.
+ */
+template <typename Start>
+class completion_awaitable<void(), Start> : private details::completion_state
+{
+  public:
+    using Delegate = delegate<void()>;
+
+    explicit completion_awaitable(Start start) : m_start(std::move(start)) {}
+
+    completion_awaitable(completion_awaitable const&) = delete;
+    completion_awaitable& operator=(completion_awaitable const&) = delete;
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        m_handle = h;
+        m_start(Delegate{&doComplete, static_cast<void*>(this)});
+        return !arrive();
+    }
+
+    void await_resume() noexcept {}
+
+  private:
+    static void doComplete(typename Delegate::DataPtr d)
+    {
+        auto* self = static_cast<completion_awaitable*>(d.ptr());
+        if (self->arrive())
+            self->m_handle.resume();
+    }
+
+    Start m_start;
+};
+
+/**
+ * Create an awaitable calling 'start' with a completion delegate of type
+ * delegate<Signature>. Signature is 'void()' or 'void(Result)'.
+ */
+template <typename Signature, typename Start>
+completion_awaitable<Signature, std::decay_t<Start>>
+async_completion(Start&& start)
+{
+    return completion_awaitable<Signature, std::decay_t<Start>>{
+        std::forward<Start>(start)};
+}
+
+#endif /* DELEGATE_COROUTINE_HPP_ */
@@ -0,0 +1,178 @@
+/*
+ * delegate_array.hpp
+ *
+ * Fixed capacity array of delegates, trampolines and data stored apart.
+ */
+
+#ifndef DELEGATE_DELEGATE_ARRAY_HPP_
+#define DELEGATE_DELEGATE_ARRAY_HPP_
+
+/**
+ * An array of delegate objects interleave trampoline and data pointers.
+ * delegate_array instead store them as a structure of arrays, one
+ * contiguous array of trampolines and one of data pointers. Iterating
+ * the trampolines only touch those cache lines.
+ *
+ * Calling a large set of delegates with many different trampolines will
+ * cause frequent mispredictions of the indirect call in the loop. Calling
+ * 'sort_by_trampoline' reorders the entries so that all delegates sharing
+ * a trampoline are adjacent. 'invoke_all' will then call consecutive
+ * entries via the same branch target. Sort after a batch of insertions,
+ * the order is not maintained by 'push_back' or 'erase'.
+ *
+ * Keeps the guarantees of the delegate:
+ * - Never heap allocate. Capacity N is set at compile time. Note that the
+ *   storage is 2 * N pointers, large arrays should have static storage.
+ * - Never throw. A full delegate_array refuses new delegates by returning
+ *   false from 'push_back'.
+ *
+ * Like delegate, this header do not include anything besides delegate.hpp,
+ * so it can be included into a custom namespace together with delegate.hpp.
+ */
+
+#include "delegate.hpp"
+
+template <typename Signature, details::size_t N>
+class delegate_array;
+
+/**
+ * @param R type of the return value from calling the callbacks.
+ * @param Args Argument list to the function when calling the callbacks.
+ * @param N Maximum number of delegates stored.
+ */
+template <typename R, typename... Args, details::size_t N>
+class delegate_array<R(Args...), N>
+{
+  public:
+    using Delegate = delegate<R(Args...)>;
+    using Trampoline = typename Delegate::Trampoline;
+    using DataPtr = typename Delegate::DataPtr;
+    using size_type = details::size_t;
+
+    constexpr delegate_array() = default;
+
+    /**
+     * Call all stored delegates in storage order. Return values are
+     * discarded.
+     */
+    void invoke_all(Args... args) const
+    {
+        for (size_type i = 0; i < m_size; ++i)
+            m_fkn[i](m_data[i], details::pass<Args>(args)...);
+    }
+
+    /**
+     * Add a delegate last. O(1).
+     * Return false, without storing anything, when full or if 'del' is null.
+     */
+    DELEGATE_CXX14CONSTEXPR bool push_back(Delegate const& del) noexcept
+    {
+        if (m_size == N || del.null())
+            return false;
+        m_fkn[m_size] = del.trampoline();
+        m_data[m_size] = del.data();
+        ++m_size;
+        return true;
+    }
+
+    /**
+     * Remove the delegate at position 'ix'. The last delegate is moved into
+     * its place. O(1). Return false if ix >= size().
+     */
+    DELEGATE_CXX14CONSTEXPR bool erase(size_type ix) noexcept
+    {
+        if (ix >= m_size)
+            return false;
+        --m_size;
+        m_fkn[ix] = m_fkn[m_size];
+        m_data[ix] = m_data[m_size];
+        return true;
+    }
+
+    /**
+     * Reorder the delegates so that the ones with equal trampoline are
+     * adjacent. In place heap sort, O(n log n), no extra storage.
+     */
+    DELEGATE_CXX14CONSTEXPR void sort_by_trampoline() noexcept
+    {
+        for (size_type i = m_size / 2; i > 0; --i)
+            siftDown(i - 1, m_size);
+        for (size_type end = m_size; end > 1; --end)
+        {
+            swap(0, end - 1);
+            siftDown(0, end - 1);
+        }
+    }
+
+    // True if delegates with equal trampolines are adjacent.
+    DELEGATE_CXX14CONSTEXPR bool sorted_by_trampoline() const noexcept
+    {
+        for (size_type i = 1; i < m_size; ++i)
+        {
+            if (m_fkn[i] < m_fkn[i - 1])
+                return false;
+        }
+        return true;
+    }
+
+    DELEGATE_CXX14CONSTEXPR void clear() noexcept
+    {
+        m_size = 0;
+    }
+
+    constexpr size_type size() const noexcept
+    {
+        return m_size;
+    }
+    static constexpr size_type capacity() noexcept
+    {
+        return N;
+    }
+    constexpr bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+    constexpr bool full() const noexcept
+    {
+        return m_size == N;
+    }
+
+    // Reassemble the delegate at position 'ix'.
+    constexpr Delegate operator[](size_type ix) const noexcept
+    {
+        return Delegate{m_fkn[ix], m_data[ix]};
+    }
+
+  private:
+    DELEGATE_CXX14CONSTEXPR void swap(size_type a, size_type b) noexcept
+    {
+        Trampoline f = m_fkn[a];
+        m_fkn[a] = m_fkn[b];
+        m_fkn[b] = f;
+        DataPtr d = m_data[a];
+        m_data[a] = m_data[b];
+        m_data[b] = d;
+    }
+
+    DELEGATE_CXX14CONSTEXPR void siftDown(size_type root, size_type end) noexcept
+    {
+        for (;;)
+        {
+            size_type child = 2 * root + 1;
+            if (child >= end)
+                return;
+            if (child + 1 < end && m_fkn[child] < m_fkn[child + 1])
+                ++child;
+            if (!(m_fkn[root] < m_fkn[child]))
+                return;
+            swap(root, child);
+            root = child;
+        }
+    }
+
+    Trampoline m_fkn[N] = {};
+    DataPtr m_data[N] = {};
+    size_type m_size = 0;
+};
+
+#endif /* DELEGATE_DELEGATE_ARRAY_HPP_ */
@@ -0,0 +1,258 @@
+/*
+ * delegate_pipeline.hpp
+ *
+ * Compile time composition of several callbacks into one trampoline.
+ * Require C++17.
+ */
+
+#ifndef DELEGATE_DELEGATE_PIPELINE_HPP_
+#define DELEGATE_DELEGATE_PIPELINE_HPP_
+
+/**
+ * A processing chain built from one delegate per stage pays one indirect
+ * call per stage and message. When the stages are known at compile time,
+ * 'compose' fuses them into one trampoline calling every stage directly,
+ * so the compiler can inline across the stages:
+ *
+ *   auto p = compose<&Decoder::decode, &Validator::validate,
+ *                    &Router::route>(decoder, validator, router);
+ *   delegate<void(Packet const&)> d = p.view();
+ *   d(packet); // router.route(validator.validate(decoder.decode(packet)))
+ *
+ * - Stages are member functions or free functions. The return value of a
+ *   stage is the argument to the next one. A stage returning void is
+ *   followed by a stage taking no arguments.
+ * - The delegate signature is the parameters of the first stage and the
+ *   return type of the last.
+ * - Objects are given in the order of the member function stages.
+ *
+ * The runtime still sees a single two word delegate from 'view'. With at
+ * most one member function stage, the delegate refers directly to the
+ * object (or nothing), and is independent of the delegate_pipeline. With
+ * more, the pipeline stores the object pointers and the delegate points to
+ * them, so the pipeline must outlive the delegate.
+ *
+ * No heap allocation, no exceptions. Trivially copyable.
+ */
+
+#include "delegate.hpp"
+
+#include <type_traits>
+#include <utility>
+
+#if DELEGATE_CPP_VERSION < 201703L
+#error "delegate_pipeline require at least C++17"
+#endif
+
+namespace details
+{
+
+// Parameters, result and object type of one stage.
+template <typename F>
+struct pipeline_stage;
+template <typename R, typename... P, bool ne>
+struct pipeline_stage<R (*)(P...) noexcept(ne)>
+{
+    using Result = R;
+    using Object = void;
+    template <typename Res>
+    using signature = Res(P...);
+    static constexpr bool member = false;
+};
+template <class T, typename R, typename... P, bool ne>
+struct pipeline_stage<R (T::*)(P...) noexcept(ne)>
+{
+    using Result = R;
+    using Object = T;
+    template <typename Res>
+    using signature = Res(P...);
+    static constexpr bool member = true;
+};
+template <class T, typename R, typename... P, bool ne>
+struct pipeline_stage<R (T::*)(P...) const noexcept(ne)>
+{
+    using Result = R;
+    using Object = T const;
+    template <typename Res>
+    using signature = Res(P...);
+    static constexpr bool member = true;
+};
+
+// Stage number I.
+template <size_t I, auto s, auto... rest>
+struct stage_at : stage_at<I - 1, rest...>
+{
+};
+template <auto s, auto... rest>
+struct stage_at<0, s, rest...>
+{
+    static constexpr auto value = s;
+};
+
+} // namespace details
+
+/**
+ * @param stages Member or free function pointers, called in order.
+ */
+template <auto... stages>
+class delegate_pipeline
+{
+    static_assert(sizeof...(stages) > 0,
+                  "delegate_pipeline require at least one stage");
+
+    static constexpr details::size_t N = sizeof...(stages);
+
+    template <details::size_t I>
+    using Stage = details::pipeline_stage<std::remove_const_t<
+        decltype(details::stage_at<I, stages...>::value)>>;
+
+  public:
+    // Number of member function stages, i.e. of objects.
+    static constexpr details::size_t objects =
+        (details::size_t{details::pipeline_stage<decltype(stages)>::member} +
+         ...);
+
+    using Result = typename Stage<N - 1>::Result;
+    using Signature = typename Stage<0>::template signature<Result>;
+    using Delegate = delegate<Signature>;
+    using DataPtr = typename Delegate::DataPtr;
+
+    /**
+     * One object per member function stage, in stage order. Const objects
+     * are only accepted for const member functions.
+     */
+    template <class... T,
+              std::enable_if_t<sizeof...(T) == objects &&
+                                   !(std::is_same<std::remove_const_t<T>,
+                                                  delegate_pipeline>::value ||
+                                     ...),
+                               int> = 0>
+    constexpr explicit delegate_pipeline(T&... objs) noexcept
+        : delegate_pipeline(std::make_index_sequence<objects>{}, objs...)
+    {
+    }
+
+    // Delegate calling the fused stages.
+    constexpr Delegate view() const& noexcept
+    {
+        return doView(static_cast<Signature*>(nullptr));
+    }
+    // With several objects, a view of a temporary would dangle.
+    template <details::size_t M = objects,
+              std::enable_if_t<(M > 1), int> = 0>
+    Delegate view() const&& = delete;
+
+    // Call the stages directly, without the trampoline.
+    template <typename... A>
+    DELEGATE_ALWAYS_INLINE constexpr Result operator()(A&&... args) const
+    {
+        return run<0, 0>(m_objs, static_cast<A&&>(args)...);
+    }
+
+  private:
+    // Stage index of member function stage number k.
+    static constexpr details::size_t memberStage(details::size_t k) noexcept
+    {
+        constexpr bool member[] = {
+            details::pipeline_stage<decltype(stages)>::member...};
+        for (details::size_t i = 0; i < N; ++i)
+        {
+            if (member[i] && k-- == 0)
+                return i;
+        }
+        return N;
+    }
+
+    template <details::size_t K, class T>
+    static constexpr void* toVoid(T& obj) noexcept
+    {
+        using Object = typename Stage<memberStage(K)>::Object;
+        Object* p = &obj;
+        return const_cast<void*>(static_cast<void const*>(p));
+    }
+
+    template <details::size_t... K, class... T>
+    constexpr delegate_pipeline(std::index_sequence<K...>, T&... objs) noexcept
+        : m_objs{toVoid<K>(objs)...}
+    {
+    }
+
+    // Call stage I with 'args', then the rest of the stages with its
+    // result. 'Obj' is the index of the object for the next member stage.
+    template <details::size_t I, details::size_t Obj, typename... P>
+    DELEGATE_ALWAYS_INLINE static constexpr Result run(void* const* objs,
+                                                       P&&... args)
+    {
+        using S = Stage<I>;
+        constexpr details::size_t next = Obj + (S::member ? 1 : 0);
+        if constexpr (I + 1 == N)
+            return invoke<I, Obj>(objs, static_cast<P&&>(args)...);
+        else if constexpr (std::is_void<typename S::Result>::value)
+        {
+            invoke<I, Obj>(objs, static_cast<P&&>(args)...);
+            return run<I + 1, next>(objs);
+        }
+        else
+        {
+            return run<I + 1, next>(
+                objs, invoke<I, Obj>(objs, static_cast<P&&>(args)...));
+        }
+    }
+
+    template <details::size_t I, details::size_t Obj, typename... P>
+    DELEGATE_ALWAYS_INLINE static constexpr typename Stage<I>::Result
+    invoke(void* const* objs, P&&... args)
+    {
+        constexpr auto fkn = details::stage_at<I, stages...>::value;
+        using S = Stage<I>;
+        if constexpr (S::member)
+        {
+            auto obj = static_cast<typename S::Object*>(objs[Obj]);
+            return (obj->*fkn)(static_cast<P&&>(args)...);
+        }
+        else
+            return fkn(static_cast<P&&>(args)...);
+    }
+
+    template <typename... Args>
+    static Result doPipeline(DataPtr o, details::param_t<Args>... args)
+    {
+        if constexpr (objects > 1)
+        {
+            return run<0, 0>(static_cast<void* const*>(o.ptr()),
+                             details::fwd<Args>(args)...);
+        }
+        else
+        {
+            void* const obj = o.ptr();
+            return run<0, 0>(&obj, details::fwd<Args>(args)...);
+        }
+    }
+
+    // Deduce the parameters of the first stage for the trampoline.
+    template <typename R, typename... Args>
+    constexpr Delegate doView(R (*)(Args...)) const noexcept
+    {
+        void* data = nullptr;
+        if constexpr (objects > 1)
+            data = const_cast<void*>(static_cast<void const*>(m_objs));
+        else if constexpr (objects == 1)
+            data = m_objs[0];
+        return Delegate{&doPipeline<Args...>, data};
+    }
+
+    void* m_objs[objects > 0 ? objects : 1] = {};
+};
+
+/**
+ * Fuse 'stages' into one delegate_pipeline. 'objs' are the objects for the
+ * member function stages, in order.
+ */
+template <auto... stages, class... T>
+constexpr delegate_pipeline<stages...>
+compose(T&... objs) noexcept
+{
+    return delegate_pipeline<stages...>(objs...);
+}
+
+#endif /* DELEGATE_DELEGATE_PIPELINE_HPP_ */
@@ -0,0 +1,266 @@
+/*
+ * delegate_queue.hpp
+ *
+ * Fixed capacity lock-free queue of deferred delegate calls.
+ */
+
+#ifndef DELEGATE_DELEGATE_QUEUE_HPP_
+#define DELEGATE_DELEGATE_QUEUE_HPP_
+
+/**
+ * Post calls to another thread: the producer pushes a delegate together
+ * with the call arguments, the consumer later calls them in FIFO order
+ * with 'drain'.
+ *
+ *   delegate_queue<void(int), 1024> q;
+ *   q.push(delegate<void(int)>::make<Obj, &Obj::onData>(obj), 42);
+ *   ...
+ *   q.drain(); // Calls obj.onData(42).
+ *
+ * The arguments are stored inline in the slot next to the delegate, so no
+ * closure object is needed. They must be trivially copyable, as the
+ * delegate.
+ *
+ * Two variants, selected by the 'Mode' parameter:
+ * - queue_spsc : One producer and one consumer thread. Wait-free push and
+ *   drain. A drain of many calls does one atomic store at the end.
+ * - queue_mpsc : Any number of producer threads, one consumer thread. A
+ *   bounded queue with a sequence number per slot (D. Vyukov). Push is
+ *   lock-free, one compare and swap when uncontended.
+ *
+ * Properties:
+ * - No heap allocation, capacity N is a compile time power of 2.
+ * - No exceptions. A full queue refuses new calls, 'push' returns false.
+ * - Producer and consumer indexes are on separate cache lines.
+ * - A delegate called by 'drain' may push to the same queue. For queue_spsc
+ *   only if the consumer thread is also the producer.
+ */
+
+#include "arg_pack.hpp"
+#include "delegate.hpp"
+
+#include <atomic>
+#include <type_traits>
+
+namespace details
+{
+
+// A delegate and the arguments to call it with.
+template <typename... Args>
+struct queue_slot
+{
+    using Delegate = delegate<void(Args...)>;
+    using Pack = arg_pack<typename std::decay<Args>::type...>;
+
+    static_assert(all_trivially_copyable<Pack>::value,
+                  "delegate_queue arguments must be trivially copyable");
+
+    void call() const
+    {
+        callWithPack(del, args);
+    }
+
+    Delegate del;
+    Pack args;
+};
+
+} // namespace details
+
+// Single producer, single consumer.
+struct queue_spsc
+{
+};
+// Multiple producers, single consumer.
+struct queue_mpsc
+{
+};
+
+template <typename Signature, details::size_t N, typename Mode = queue_spsc>
+class delegate_queue;
+
+/**
+ * Single producer, single consumer variant.
+ * @param Args Argument list to the delegates.
+ * @param N Capacity, must be a power of 2.
+ */
+template <typename... Args, details::size_t N>
+class delegate_queue<void(Args...), N, queue_spsc>
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of 2");
+
+  public:
+    using Delegate = delegate<void(Args...)>;
+    using size_type = details::size_t;
+
+    delegate_queue() = default;
+    delegate_queue(delegate_queue const&) = delete;
+    delegate_queue& operator=(delegate_queue const&) = delete;
+
+    /**
+     * Store 'del' and 'args' for a later call. Only call from the producer
+     * thread. Return false if the queue is full.
+     */
+    bool push(Delegate const& del, Args const&... args) noexcept
+    {
+        size_type const tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == N)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == N)
+                return false;
+        }
+        Slot& s = m_slots[tail & (N - 1)];
+        s.del = del;
+        s.args = details::makePack(args...);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Call up to 'max' stored delegates in FIFO order. Only call from the
+     * consumer thread. Return the number of calls made.
+     */
+    size_type drain(size_type max = N)
+    {
+        size_type const head = m_head.load(std::memory_order_relaxed);
+        size_type const tail = m_tail.load(std::memory_order_acquire);
+        size_type const n = tail - head < max ? tail - head : max;
+        for (size_type i = 0; i < n; ++i)
+            m_slots[(head + i) & (N - 1)].call();
+        m_head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Approximate when called concurrently with push or drain.
+    size_type size() const noexcept
+    {
+        return m_tail.load(std::memory_order_acquire) -
+               m_head.load(std::memory_order_acquire);
+    }
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+    static constexpr size_type capacity() noexcept
+    {
+        return N;
+    }
+
+  private:
+    using Slot = details::queue_slot<Args...>;
+
+    // Consumer side.
+    alignas(details::delegate_cache_line) std::atomic<size_type> m_head{0};
+    // Producer side, with a copy of the head to avoid reading m_head for
+    // each push.
+    alignas(details::delegate_cache_line) std::atomic<size_type> m_tail{0};
+    size_type m_cachedHead = 0;
+    alignas(details::delegate_cache_line) Slot m_slots[N] = {};
+};
+
+/**
+ * Multiple producer, single consumer variant.
+ * @param Args Argument list to the delegates.
+ * @param N Capacity, must be a power of 2.
+ */
+template <typename... Args, details::size_t N>
+class delegate_queue<void(Args...), N, queue_mpsc>
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of 2");
+
+  public:
+    using Delegate = delegate<void(Args...)>;
+    using size_type = details::size_t;
+
+    delegate_queue() noexcept
+    {
+        for (size_type i = 0; i < N; ++i)
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    delegate_queue(delegate_queue const&) = delete;
+    delegate_queue& operator=(delegate_queue const&) = delete;
+
+    /**
+     * Store 'del' and 'args' for a later call. Can be called from any
+     * thread. Return false if the queue is full.
+     */
+    bool push(Delegate const& del, Args const&... args) noexcept
+    {
+        size_type pos = m_tail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell& c = m_cells[pos & (N - 1)];
+            size_type const seq = c.seq.load(std::memory_order_acquire);
+            auto const dif = static_cast<long long>(seq - pos);
+            if (dif == 0)
+            {
+                if (m_tail.compare_exchange_weak(pos, pos + 1,
+                                                 std::memory_order_relaxed))
+                {
+                    c.slot.del = del;
+                    c.slot.args = details::makePack(args...);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (dif < 0)
+                return false; // Full.
+            else
+                pos = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Call up to 'max' stored delegates in FIFO order. Only call from the
+     * consumer thread. Stops at the first slot not yet completely written.
+     * Return the number of calls made.
+     */
+    size_type drain(size_type max = N)
+    {
+        size_type n = 0;
+        size_type pos = m_head.load(std::memory_order_relaxed);
+        for (; n < max; ++n, ++pos)
+        {
+            Cell& c = m_cells[pos & (N - 1)];
+            if (c.seq.load(std::memory_order_acquire) != pos + 1)
+                break;
+            c.slot.call();
+            c.seq.store(pos + N, std::memory_order_release);
+            m_head.store(pos + 1, std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    // Approximate when called concurrently with push or drain.
+    size_type size() const noexcept
+    {
+        size_type const head = m_head.load(std::memory_order_relaxed);
+        size_type const tail = m_tail.load(std::memory_order_relaxed);
+        return tail - head < N ? tail - head : N;
+    }
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+    static constexpr size_type capacity() noexcept
+    {
+        return N;
+    }
+
+  private:
+    using Slot = details::queue_slot<Args...>;
+
+    struct Cell
+    {
+        std::atomic<size_type> seq;
+        Slot slot;
+    };
+
+    // Consumer side.
+    alignas(details::delegate_cache_line) std::atomic<size_type> m_head{0};
+    // Shared by the producers.
+    alignas(details::delegate_cache_line) std::atomic<size_type> m_tail{0};
+    alignas(details::delegate_cache_line) Cell m_cells[N];
+};
+
+#endif /* DELEGATE_DELEGATE_QUEUE_HPP_ */
@@ -0,0 +1,140 @@
+/*
+ * delegate_ref.hpp
+ *
+ * Non owning callback parameter type, accepting temporaries.
+ */
+
+#ifndef DELEGATE_DELEGATE_REF_HPP_
+#define DELEGATE_DELEGATE_REF_HPP_
+
+/**
+ * delegate refuse to bind temporaries, since a stored delegate would
+ * dangle. For a callback which is only called during a function call,
+ * e.g. visitors and for_each style APIs, a temporary lambda is fine.
+ * delegate_ref<R(Args...)> is meant for such parameters:
+ *
+ *   void Tree::visit(delegate_ref<void(Node const&)> f);
+ *
+ *   tree.visit([&](Node const& n) { count += n.size(); });
+ *
+ * The API is then an ordinary function instead of a function template
+ * instantiated per caller.
+ *
+ * A delegate_ref bound to a temporary is valid until the end of the full
+ * expression creating the temporary, i.e. for the duration of the call
+ * taking the delegate_ref. Do not store it.
+ *
+ * It is a delegate internally, bound with the same trampolines as
+ * 'delegate::make'. A functor used both with delegate and delegate_ref
+ * only has one instantiated trampoline. 2 words, trivially copyable.
+ *
+ * Like delegate, this header do not include anything besides delegate.hpp,
+ * so it can be included into a custom namespace together with delegate.hpp.
+ */
+
+#include "delegate.hpp"
+
+namespace details
+{
+
+template <typename T>
+struct remove_cvref
+{
+    using type = T;
+};
+template <typename T>
+struct remove_cvref<T const>
+{
+    using type = T;
+};
+template <typename T>
+struct remove_cvref<T&> : remove_cvref<T>
+{
+};
+template <typename T>
+struct remove_cvref<T&&> : remove_cvref<T>
+{
+};
+
+template <typename T, typename U>
+struct is_same_type
+{
+    static constexpr bool value = false;
+};
+template <typename T>
+struct is_same_type<T, T>
+{
+    static constexpr bool value = true;
+};
+
+template <bool b>
+struct enable_if_true
+{
+};
+template <>
+struct enable_if_true<true>
+{
+    using type = void;
+};
+
+// Enabled if F is not one of the types Ref and Del.
+template <typename F, typename Ref, typename Del>
+using enable_functor_ref = typename enable_if_true<
+    !is_same_type<typename remove_cvref<F>::type, Ref>::value &&
+    !is_same_type<typename remove_cvref<F>::type, Del>::value>::type;
+
+} // namespace details
+
+template <typename Signature>
+class delegate_ref;
+
+/**
+ * @param R type of the return value from calling the callback.
+ * @param Args Argument list to the function when calling the callback.
+ */
+template <typename R, typename... Args DELEGATE_NE_TPARAM>
+class delegate_ref<R(Args...) DELEGATE_NE>
+{
+  public:
+    using Delegate = delegate<R(Args...) DELEGATE_NE>;
+    using FknPtr = typename Delegate::FknPtr;
+
+    // Null state, calling it returns a value initialized R.
+    constexpr delegate_ref(details::nullptr_t) noexcept {}
+
+    // Call the same target as 'd'.
+    constexpr delegate_ref(Delegate const& d) noexcept : m_del(d) {}
+
+    constexpr delegate_ref(FknPtr fkn) noexcept : m_del(fkn) {}
+
+    /**
+     * Bind to a functor or lambda, also a temporary. Only a pointer to
+     * the functor is stored.
+     */
+    template <class F,
+              typename = details::enable_functor_ref<F, delegate_ref, Delegate>>
+    constexpr delegate_ref(F&& f) noexcept
+        : m_del(Delegate::make(static_cast<F&>(f)))
+    {
+    }
+
+    DELEGATE_ALWAYS_INLINE constexpr R
+    operator()(Args... args) const DELEGATE_NE
+    {
+        return m_del(details::fwd<Args>(args)...);
+    }
+
+    constexpr bool null() const noexcept
+    {
+        return m_del.null();
+    }
+    constexpr explicit operator bool() const noexcept
+    {
+        return !null();
+    }
+
+  private:
+    Delegate m_del;
+};
+
+#endif /* DELEGATE_DELEGATE_REF_HPP_ */
@@ -0,0 +1,283 @@
+/*
+ * delegate_table.hpp
+ *
+ * Compile time key -> delegate dispatch table. Require C++17.
+ */
+
+#ifndef DELEGATE_DELEGATE_TABLE_HPP_
+#define DELEGATE_DELEGATE_TABLE_HPP_
+
+/**
+ * Map from a set of integer or enum keys to handlers, built entirely at
+ * compile time. Intended for e.g. opcode/command dispatch in protocol
+ * decoders:
+ *
+ *   using Table = delegate_table<void(Msg const&),
+ *                                table_entry<Op::read, &onRead>,
+ *                                table_entry<Op::write, &Dev::write, &s_dev>>;
+ *   Table::call(msg.op, msg);
+ *
+ * Each entry is a key and a free function, or a key, a member function and
+ * a pointer to an object with static storage duration.
+ *
+ * The table is a constexpr static array of delegates so it is constant
+ * initialized, no startup cost, and placed in read-only memory (.rodata,
+ * or .data.rel.ro when relocations are needed). Two layouts are selected
+ * at compile time:
+ * - Dense: keys cover at least half of the range min..max. The key minus
+ *   the smallest key index the table directly.
+ * - Sparse: a multiplicative perfect hash, searched at compile time, maps
+ *   the keys to a power of 2 sized table without collisions. The stored
+ *   key in the slot is compared to reject unknown keys.
+ *
+ * In both cases unknown keys select a null delegate at the end of the
+ * table instead of branching to separate code. A call is then a single
+ * indexed indirect call. Calling an unknown key returns a value initialized
+ * R, as for a null delegate.
+ */
+
+#include "delegate.hpp"
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#if DELEGATE_CPP_VERSION < 201703L
+#error "delegate_table require at least C++17"
+#endif
+
+/**
+ * Entry in a delegate_table.
+ * @param Key Integral or enum key.
+ * @param Fkn Free function, or member function if Obj is given.
+ * @param Obj Optional pointer to the object to call the member function on.
+ */
+template <auto Key, auto Fkn, auto... Obj>
+struct table_entry
+{
+    static_assert(sizeof...(Obj) <= 1, "At most one object per entry");
+
+    static constexpr auto key = Key;
+
+    template <typename Delegate>
+    static constexpr Delegate make() noexcept
+    {
+        if constexpr (sizeof...(Obj) == 0)
+            return Delegate::template make<Fkn>();
+        else
+            return Delegate::template make<Fkn>(*Obj...);
+    }
+};
+
+namespace details
+{
+
+// Map keys to unsigned values, keeping the order for signed keys.
+template <typename K>
+constexpr std::uint64_t
+tableKey(K k) noexcept
+{
+    static_assert(std::is_integral<K>::value || std::is_enum<K>::value,
+                  "delegate_table keys must be integral or enum");
+    if constexpr (std::is_enum<K>::value)
+        return tableKey(static_cast<std::underlying_type_t<K>>(k));
+    else if constexpr (std::is_signed<K>::value)
+        return static_cast<std::uint64_t>(static_cast<std::int64_t>(k)) ^
+               (std::uint64_t{1} << 63);
+    else
+        return static_cast<std::uint64_t>(k);
+}
+
+constexpr std::uint64_t
+tableHash(std::uint64_t k, std::uint64_t mult, unsigned bits) noexcept
+{
+    return bits == 0 ? 0 : (k * mult) >> (64 - bits);
+}
+
+// Result of the perfect hash search.
+struct table_hash_params
+{
+    std::uint64_t mult = 0;
+    unsigned bits = 0;
+    bool found = false;
+};
+
+template <details::size_t N>
+constexpr table_hash_params
+findPerfectHash(std::array<std::uint64_t, N> const& keys) noexcept
+{
+    unsigned minBits = 0;
+    while ((details::size_t{1} << minBits) < N)
+        ++minBits;
+
+    // Try the smallest table first, then allow up to 8 times larger.
+    for (unsigned bits = minBits; bits <= minBits + 3; ++bits)
+    {
+        std::uint64_t mult = 0x9e3779b97f4a7c15u;
+        for (int attempt = 0; attempt < 2000; ++attempt)
+        {
+            bool ok = true;
+            for (details::size_t i = 0; ok && i < N; ++i)
+            {
+                for (details::size_t j = i + 1; ok && j < N; ++j)
+                {
+                    ok = tableHash(keys[i], mult, bits) !=
+                         tableHash(keys[j], mult, bits);
+                }
+            }
+            if (ok)
+                return table_hash_params{mult, bits, true};
+            // Next odd multiplier from an LCG.
+            mult = (mult * 6364136223846793005u + 1442695040888963407u) | 1u;
+        }
+    }
+    return table_hash_params{};
+}
+
+} // namespace details
+
+template <typename Signature, typename... Entries>
+class delegate_table;
+
+/**
+ * @param R type of the return value from calling the handlers.
+ * @param Args Argument list when calling the handlers.
+ * @param Entries table_entry types.
+ */
+template <typename R, typename... Args, typename... Entries>
+class delegate_table<R(Args...), Entries...>
+{
+    static_assert(sizeof...(Entries) > 0, "delegate_table needs entries");
+
+  public:
+    using Delegate = delegate<R(Args...)>;
+    using key_type = std::common_type_t<decltype(Entries::key)...>;
+    using size_type = details::size_t;
+
+  private:
+    static constexpr size_type N = sizeof...(Entries);
+    static constexpr std::array<std::uint64_t, N> s_keys = {
+        details::tableKey(static_cast<key_type>(Entries::key))...};
+
+    static constexpr std::uint64_t minKey() noexcept
+    {
+        std::uint64_t m = s_keys[0];
+        for (auto k : s_keys)
+            m = k < m ? k : m;
+        return m;
+    }
+    static constexpr std::uint64_t maxKey() noexcept
+    {
+        std::uint64_t m = s_keys[0];
+        for (auto k : s_keys)
+            m = k > m ? k : m;
+        return m;
+    }
+    static constexpr bool uniqueKeys() noexcept
+    {
+        for (size_type i = 0; i < N; ++i)
+            for (size_type j = i + 1; j < N; ++j)
+                if (s_keys[i] == s_keys[j])
+                    return false;
+        return true;
+    }
+    static_assert(uniqueKeys(), "delegate_table keys must be unique");
+
+    static constexpr std::uint64_t s_min = minKey();
+    static constexpr std::uint64_t s_span = maxKey() - s_min + 1;
+
+  public:
+    // True if the table is indexed directly by key, false if hashed.
+    static constexpr bool dense = s_span <= 2 * N;
+
+  private:
+    static constexpr details::table_hash_params s_hash =
+        dense ? details::table_hash_params{}
+              : details::findPerfectHash(s_keys);
+    static_assert(dense || s_hash.found,
+                  "No perfect hash found for the delegate_table keys");
+
+    static constexpr size_type s_slots =
+        dense ? size_type(s_span) : size_type{1} << s_hash.bits;
+
+    static constexpr size_type slotOf(std::uint64_t k) noexcept
+    {
+        if constexpr (dense)
+            return size_type(k - s_min);
+        else
+            return size_type(details::tableHash(k, s_hash.mult, s_hash.bits));
+    }
+
+    // Delegates per slot, plus a null delegate last for unknown keys.
+    static constexpr std::array<Delegate, s_slots + 1> buildTable() noexcept
+    {
+        std::array<Delegate, s_slots + 1> t{};
+        size_type i = 0;
+        ((t[slotOf(s_keys[i++])] = Entries::template make<Delegate>()), ...);
+        return t;
+    }
+    // Key per slot, only used by the sparse layout.
+    static constexpr std::array<std::uint64_t, dense ? 1 : s_slots>
+    buildKeys() noexcept
+    {
+        std::array<std::uint64_t, dense ? 1 : s_slots> t{};
+        if constexpr (!dense)
+        {
+            for (auto k : s_keys)
+                t[slotOf(k)] = k;
+        }
+        return t;
+    }
+
+    static constexpr std::array<Delegate, s_slots + 1> s_table = buildTable();
+    static constexpr std::array<std::uint64_t, dense ? 1 : s_slots>
+        s_slotKeys = buildKeys();
+
+    static constexpr size_type index(key_type key) noexcept
+    {
+        std::uint64_t const k = details::tableKey(key);
+        if constexpr (dense)
+        {
+            // Keys below s_min wrap around to large values.
+            std::uint64_t const ix = k - s_min;
+            return ix < s_span ? size_type(ix) : s_slots;
+        }
+        else
+        {
+            size_type const ix = slotOf(k);
+            return s_slotKeys[ix] == k ? ix : s_slots;
+        }
+    }
+
+  public:
+    // Return the delegate for 'key', a null delegate for unknown keys.
+    static constexpr Delegate find(key_type key) noexcept
+    {
+        return s_table[index(key)];
+    }
+
+    static constexpr bool contains(key_type key) noexcept
+    {
+        // Holes in the dense layout hold null delegates.
+        return !s_table[index(key)].null();
+    }
+
+    // Call the handler for 'key'. Unknown keys return a value initialized R.
+    static R call(key_type key, Args... args)
+    {
+        return s_table[index(key)](details::fwd<Args>(args)...);
+    }
+
+    static constexpr size_type size() noexcept
+    {
+        return N;
+    }
+
+    // Number of slots in the table, excluding the null slot.
+    static constexpr size_type slots() noexcept
+    {
+        return s_slots;
+    }
+};
+
+#endif /* DELEGATE_DELEGATE_TABLE_HPP_ */
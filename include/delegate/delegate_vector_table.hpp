@@ -0,0 +1,211 @@
+/*
+ * delegate_vector_table.hpp
+ *
+ * Interrupt handlers dispatching through statically allocated delegates.
+ */
+
+#ifndef DELEGATE_DELEGATE_VECTOR_TABLE_HPP_
+#define DELEGATE_DELEGATE_VECTOR_TABLE_HPP_
+
+/**
+ * A common setup is one generic interrupt handler indexing a global array
+ * of delegate<void()> by the active vector number. delegate_vector_table
+ * instead give each vector its own handler, 'handler<I>', reading the
+ * delegate from a fixed slot known at link time. It compiles to two loads
+ * and a tail call, checked by test/codegen_vector_table.cpp. On x86-64:
+ *
+ *   mov  slot_I(%rip), %rax
+ *   mov  slot_I+8(%rip), %rdi
+ *   jmp  *%rax
+ *
+ * and on Cortex-M to a load of the slot address, two loads and 'bx'
+ * (atomic loads of aligned words are plain 'ldr'). The handlers are plain
+ * functions without state. Put them directly in the hardware vector table
+ * via 'handlers()', or bind them to the names used by the startup code:
+ *
+ *   struct Irq {};
+ *   using Vectors = delegate_vector_table<16, Irq>;
+ *   DELEGATE_VECTOR_HANDLER(Vectors, 5, USART1_IRQHandler)
+ *
+ *   Vectors::set<5>(delegate<void()>::make<Uart, &Uart::onIrq>(uart));
+ *
+ * The slots are constant initialized to the null delegate, so interrupts
+ * arriving before 'set' are ignored. 'Tag' makes distinct tables with
+ * distinct slots.
+ *
+ * Rebinding with 'set' is safe while the vector's interrupt may fire, with
+ * the same guarantee as atomic_delegate: a handler interrupting 'set'
+ * always calls a trampoline/data pair which was stored together. 'set'
+ * first stores the new delegate in a staging slot, then points the
+ * trampoline to one calling the staged delegate, then writes the new data
+ * and trampoline. Every intermediate state is consistent, so the plain
+ * loads in the handler need no retry.
+ *
+ * The guarantee hold when the handler runs either before, after or
+ * interrupting 'set', as for interrupts on a single core. 'set' itself must
+ * not interrupt a handler of the same vector half way, i.e. call it from a
+ * priority not higher than the vector's interrupt, or mask it. 'get' reads
+ * the slot as the handler does, also following the staged delegate, with
+ * the same guarantee.
+ *
+ * Nothing waits, so 'set' and 'get' may be called from any context, also
+ * from interrupt handlers. Each vector has a busy flag taken by 'set'. A
+ * 'set' finding it taken, i.e. interrupting, or on a multi core racing
+ * with, another 'set' of the same vector, changes nothing and returns
+ * false. Different vectors are independent.
+ *
+ * As for delegate, no heap allocation and no exceptions.
+ */
+
+#include "arg_pack.hpp"
+#include "delegate.hpp"
+
+#include <atomic>
+
+namespace details
+{
+
+// Not defined here. Lets tests reach the intermediate states of 'set'.
+template <typename Table>
+struct vector_table_access;
+
+} // namespace details
+
+/**
+ * @param N Number of vectors.
+ * @param Tag Type making the table and its storage unique.
+ */
+template <details::size_t N, typename Tag = void>
+class delegate_vector_table
+{
+  public:
+    using Delegate = delegate<void()>;
+    using Handler = void (*)();
+
+    static constexpr details::size_t size = N;
+
+    struct handler_array
+    {
+        Handler value[N];
+    };
+
+    /**
+     * Call the delegate for vector I. Two loads and a tail call, no
+     * branches.
+     */
+    template <details::size_t I>
+    static void handler()
+    {
+        static_assert(I < N, "vector index out of range");
+        Slot const& s = s_slots[I];
+        Delegate{s.m_fkn.load(std::memory_order_relaxed),
+                 s.m_data.load(std::memory_order_relaxed)}();
+    }
+
+    // All handlers, in vector order. Usable as a constant initializer.
+    static constexpr handler_array handlers() noexcept
+    {
+        return makeHandlers(typename details::make_index_seq<N>::type{});
+    }
+
+    /**
+     * Bind vector I to 'd'. A null 'd' ignores the interrupt. Return false,
+     * leaving the binding unchanged, if another 'set' of vector I is in
+     * progress.
+     */
+    template <details::size_t I>
+    static bool set(Delegate d) noexcept
+    {
+        static_assert(I < N, "vector index out of range");
+        if (s_busy[I].exchange(true, std::memory_order_acquire))
+            return false;
+        Slot& s = s_slots[I];
+        Slot& staged = s_staged[I];
+        staged.m_fkn.store(d.trampoline(), std::memory_order_relaxed);
+        staged.m_data.store(d.data(), std::memory_order_relaxed);
+        // Each state below is a consistent pair, the handler may see it.
+        s.m_fkn.store(&doStaged<I>, std::memory_order_release);
+        s.m_data.store(d.data(), std::memory_order_release);
+        s.m_fkn.store(d.trampoline(), std::memory_order_release);
+        s_busy[I].store(false, std::memory_order_release);
+        return true;
+    }
+
+    template <details::size_t I>
+    static bool clear() noexcept
+    {
+        return set<I>(Delegate{});
+    }
+
+    // The delegate vector I is bound to. No lock, reads as 'handler<I>'.
+    template <details::size_t I>
+    static Delegate get() noexcept
+    {
+        static_assert(I < N, "vector index out of range");
+        Slot const& s = s_slots[I];
+        Trampoline const fkn = s.m_fkn.load(std::memory_order_acquire);
+        if (fkn == &doStaged<I>)
+        {
+            Slot const& staged = s_staged[I];
+            return Delegate{staged.m_fkn.load(std::memory_order_relaxed),
+                            staged.m_data.load(std::memory_order_relaxed)};
+        }
+        return Delegate{fkn, s.m_data.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    friend struct details::vector_table_access<delegate_vector_table>;
+
+    using DataPtr = Delegate::DataPtr;
+    using Trampoline = Delegate::Trampoline;
+
+    // Both words in one aligned block, never split over cache lines.
+    struct alignas(2 * sizeof(void*)) Slot
+    {
+        std::atomic<Trampoline> m_fkn{&details::common<void()>::doNullCB};
+        std::atomic<DataPtr> m_data{DataPtr{}};
+    };
+
+    // Trampoline used while 'set' writes the slot of vector I.
+    template <details::size_t I>
+    static void doStaged(DataPtr)
+    {
+        Slot const& s = s_staged[I];
+        Delegate{s.m_fkn.load(std::memory_order_relaxed),
+                 s.m_data.load(std::memory_order_relaxed)}();
+    }
+
+    template <details::size_t... I>
+    static constexpr handler_array
+    makeHandlers(details::index_seq<I...>) noexcept
+    {
+        return handler_array{{&handler<I>...}};
+    }
+
+    static Slot s_slots[N];
+    static Slot s_staged[N];
+    static std::atomic<bool> s_busy[N];
+};
+
+template <details::size_t N, typename Tag>
+typename delegate_vector_table<N, Tag>::Slot
+    delegate_vector_table<N, Tag>::s_slots[N];
+
+template <details::size_t N, typename Tag>
+typename delegate_vector_table<N, Tag>::Slot
+    delegate_vector_table<N, Tag>::s_staged[N];
+
+template <details::size_t N, typename Tag>
+std::atomic<bool> delegate_vector_table<N, Tag>::s_busy[N] = {};
+
+/**
+ * Define an extern "C" function 'name' calling the handler of vector
+ * 'index' in 'Table', for startup code referring to handlers by name.
+ */
+#define DELEGATE_VECTOR_HANDLER(Table, index, name)                            \
+    extern "C" void name()                                                     \
+    {                                                                          \
+        Table::template handler<index>();                                      \
+    }
+
+#endif /* DELEGATE_DELEGATE_VECTOR_TABLE_HPP_ */
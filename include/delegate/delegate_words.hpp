@@ -0,0 +1,49 @@
+/*
+ * delegate_words.hpp
+ *
+ * Raw 2 word representation of a delegate.
+ */
+
+#ifndef DELEGATE_DELEGATE_WORDS_HPP_
+#define DELEGATE_DELEGATE_WORDS_HPP_
+
+/**
+ * Copy a delegate to and from 2 pointer sized words, for code storing
+ * delegates in atomics, e.g. atomic_delegate and executor.
+ */
+
+#include <cstdint>
+#include <cstring>
+
+namespace details
+{
+
+// Raw representation of a delegate, 2 pointer sized words.
+struct delegate_words
+{
+    std::uintptr_t w[2];
+};
+
+template <typename Del>
+delegate_words
+toWords(Del const& d) noexcept
+{
+    static_assert(sizeof(Del) == sizeof(delegate_words),
+                  "delegate expected to be 2 words");
+    delegate_words w;
+    std::memcpy(&w, &d, sizeof w);
+    return w;
+}
+
+template <typename Del>
+Del
+fromWords(delegate_words const& w) noexcept
+{
+    Del d;
+    std::memcpy(static_cast<void*>(&d), &w, sizeof d);
+    return d;
+}
+
+} // namespace details
+
+#endif /* DELEGATE_DELEGATE_WORDS_HPP_ */
@@ -0,0 +1,496 @@
+/*
+ * executor.hpp
+ *
+ * Work stealing thread pool running delegate<void()> tasks.
+ */
+
+#ifndef DELEGATE_EXECUTOR_HPP_
+#define DELEGATE_EXECUTOR_HPP_
+
+/**
+ * A task is a delegate<void()>, 2 words and trivially copyable. Queuing a
+ * task never copies a closure or allocates, unlike std::function.
+ *
+ *   delegate_executor pool{4};
+ *   pool.submit(delegate<void()>::make<Job, &Job::run>(job));
+ *   pool.parallel_for(0, n, 1024, delegate<void(size_t, size_t)>::make(body));
+ *
+ * As for all delegates only a pointer to the target object is stored, so
+ * it must be alive until the task has run.
+ *
+ * Each worker owns a fixed capacity Chase-Lev deque (Le et al., "Correct
+ * and efficient work-stealing for weak memory models"). A worker pushes
+ * and pops its own tasks at the bottom, idle workers steal from the top of
+ * other workers' deques. Tasks submitted from outside the pool, or when the
+ * local deque is full, go to a shared mutex protected FIFO ring, which
+ * workers move to their deque in batches, oldest first. The ring has a
+ * fixed capacity allocated by the constructor, 'submit' return false when
+ * it is full. Idle workers spin shortly, then sleep.
+ *
+ * The destructor lets the workers run all submitted tasks, also those
+ * submitted by running tasks, before joining them.
+ */
+
+#include "delegate.hpp"
+#include "delegate_words.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace details
+{
+
+/**
+ * Fixed capacity work stealing deque of delegates. 'push' and 'take' only
+ * from the owner thread, 'steal' from any thread. The delegates are stored
+ * as atomic words since a thief may read a slot concurrently with a push.
+ */
+template <typename Del>
+class chase_lev_deque
+{
+  public:
+    using size_type = std::size_t;
+
+    // 'capacity' must be a power of 2.
+    explicit chase_lev_deque(size_type capacity)
+        : m_mask(capacity - 1), m_slots(new Slot[capacity]())
+    {
+    }
+
+    // Add a task. Return false if full.
+    bool push(Del const& d) noexcept
+    {
+        std::int64_t const b = m_bottom.load(std::memory_order_relaxed);
+        std::int64_t const t = m_top.load(std::memory_order_acquire);
+        if (b - t > static_cast<std::int64_t>(m_mask))
+            return false;
+        slot(b).store(d);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Take the most recently pushed task. Return false if empty.
+    bool take(Del& d) noexcept
+    {
+        std::int64_t const b = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = m_top.load(std::memory_order_relaxed);
+        if (t > b)
+        {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        d = slot(b).load();
+        if (t == b)
+        {
+            // Last task, race with thieves.
+            bool const won = m_top.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst,
+                std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Take the oldest task. Return false if empty or lost a race.
+    bool steal(Del& d) noexcept
+    {
+        std::int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t const b = m_bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return false;
+        d = slot(t).load();
+        return m_top.compare_exchange_strong(t, t + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed);
+    }
+
+    // Free slots, from the owner thread. Thieves only add room, so at least
+    // this many pushes succeed.
+    size_type room() const noexcept
+    {
+        std::int64_t const b = m_bottom.load(std::memory_order_relaxed);
+        std::int64_t const t = m_top.load(std::memory_order_acquire);
+        return m_mask + 1 - static_cast<size_type>(b - t);
+    }
+
+    // Approximate when called concurrently.
+    bool empty() const noexcept
+    {
+        return m_bottom.load(std::memory_order_relaxed) <=
+               m_top.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Slot
+    {
+        void store(Del const& d) noexcept
+        {
+            delegate_words const v = toWords(d);
+            w[0].store(v.w[0], std::memory_order_relaxed);
+            w[1].store(v.w[1], std::memory_order_relaxed);
+        }
+        Del load() const noexcept
+        {
+            delegate_words v;
+            v.w[0] = w[0].load(std::memory_order_relaxed);
+            v.w[1] = w[1].load(std::memory_order_relaxed);
+            return fromWords<Del>(v);
+        }
+        std::atomic<std::uintptr_t> w[2];
+    };
+
+    Slot& slot(std::int64_t i) const noexcept
+    {
+        return m_slots[static_cast<size_type>(i) & m_mask];
+    }
+
+    // Padded rather than aligned, over aligned new require C++17.
+    std::atomic<std::int64_t> m_top{0};
+    char m_pad[delegate_cache_line - sizeof(std::atomic<std::int64_t>)];
+    std::atomic<std::int64_t> m_bottom{0};
+    size_type const m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+};
+
+} // namespace details
+
+class delegate_executor
+{
+  public:
+    using Task = delegate<void()>;
+    using RangeTask = delegate<void(std::size_t, std::size_t)>;
+    using size_type = std::size_t;
+
+    /**
+     * Start 'threads' workers, default one per hardware thread. Each has a
+     * deque for 'queueCapacity' tasks, rounded up to a power of 2, and so
+     * does the shared queue for external submissions.
+     */
+    explicit delegate_executor(unsigned threads = 0,
+                               size_type queueCapacity = 4096)
+        : m_injectMask(roundUp(queueCapacity) - 1),
+          m_inject(new Task[m_injectMask + 1]())
+    {
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+        size_type const cap = m_injectMask + 1;
+        for (unsigned i = 0; i < threads; ++i)
+            m_workers.emplace_back(new Worker{cap});
+        for (unsigned i = 0; i < threads; ++i)
+            m_workers[i]->thread = std::thread{[this, i] { run(i); }};
+    }
+
+    delegate_executor(delegate_executor const&) = delete;
+    delegate_executor& operator=(delegate_executor const&) = delete;
+
+    // Run the remaining tasks, then stop the workers.
+    ~delegate_executor()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_sleepMutex};
+            m_stop.store(true);
+        }
+        m_wake.notify_all();
+        for (auto& w : m_workers)
+            w->thread.join();
+    }
+
+    unsigned size() const noexcept
+    {
+        return static_cast<unsigned>(m_workers.size());
+    }
+
+    /**
+     * Queue 'task' for execution on some worker. Null tasks are ignored.
+     * Return false if the queue is full and 'task' was not queued.
+     */
+    bool submit(Task const& task)
+    {
+        return submit(&task, 1) == 1;
+    }
+
+    /**
+     * Queue 'n' tasks. From outside the pool, takes the lock once. Return
+     * the number of tasks from the start of 'tasks' queued (or ignored as
+     * null), less than 'n' if the queue became full.
+     */
+    size_type submit(Task const* tasks, size_type n)
+    {
+        Worker* self = current();
+        size_type i = 0;
+        size_type added = 0;
+        for (; self && i < n; ++i)
+        {
+            if (tasks[i].null())
+                continue;
+            // Count before the push, a thief may take it right away.
+            m_queued.fetch_add(1);
+            if (!self->deque.push(tasks[i]))
+            {
+                m_queued.fetch_sub(1);
+                break;
+            }
+            ++added;
+        }
+        if (i < n)
+        {
+            size_type injected = 0;
+            std::lock_guard<std::mutex> lock{m_injectMutex};
+            size_type size = m_injectSize.load(std::memory_order_relaxed);
+            for (; i < n; ++i)
+            {
+                if (tasks[i].null())
+                    continue;
+                if (size > m_injectMask)
+                    break;
+                m_inject[(m_injectHead + size++) & m_injectMask] = tasks[i];
+                ++injected;
+            }
+            m_queued.fetch_add(injected);
+            m_injectSize.store(size, std::memory_order_relaxed);
+            added += injected;
+        }
+        wake(added);
+        return i;
+    }
+
+    /**
+     * Call 'body(first, last)' for sub ranges of [begin, end), of at most
+     * 'grain' indexes, in parallel. Return when all calls are done. The
+     * calling thread takes part and run other tasks while waiting.
+     */
+    void parallel_for(size_type begin, size_type end, size_type grain,
+                      RangeTask const& body)
+    {
+        if (begin >= end)
+            return;
+        ForState st{begin, end, grain ? grain : 1, body};
+
+        size_type const chunks = (end - begin + st.grain - 1) / st.grain;
+        size_type helpers = size() < chunks ? size() : chunks - 1;
+        st.pending.store(helpers);
+        Task const t = Task::make<ForState, &ForState::runHelper>(st);
+        for (size_type i = 0; i < helpers; ++i)
+        {
+            // With the queue full, run the chunks with fewer helpers.
+            if (!submit(t))
+            {
+                st.pending.fetch_sub(helpers - i);
+                break;
+            }
+        }
+
+        st.run();
+        // Helpers reference 'st', wait for all of them.
+        while (st.pending.load(std::memory_order_acquire) != 0)
+        {
+            if (!runOne())
+                std::this_thread::yield();
+        }
+    }
+
+    /**
+     * Run one queued task on the calling thread, if any. Return false if no
+     * task was found.
+     */
+    bool runOne()
+    {
+        Task t;
+        Worker* self = current();
+        if (!findTask(self, self ? self->index : 0, t))
+            return false;
+        t();
+        return true;
+    }
+
+  private:
+    struct Worker
+    {
+        explicit Worker(size_type cap) : deque(cap) {}
+        details::chase_lev_deque<Task> deque;
+        std::thread thread;
+        unsigned index = 0;
+        delegate_executor* owner = nullptr;
+    };
+
+    struct ForState
+    {
+        ForState(size_type b, size_type e, size_type g, RangeTask const& f)
+            : next(b), end(e), grain(g), body(f)
+        {
+        }
+        void run()
+        {
+            for (;;)
+            {
+                size_type const first = next.fetch_add(grain);
+                if (first >= end)
+                    return;
+                size_type const last =
+                    end - first < grain ? end : first + grain;
+                body(first, last);
+            }
+        }
+        void runHelper()
+        {
+            run();
+            pending.fetch_sub(1, std::memory_order_release);
+        }
+
+        std::atomic<size_type> next;
+        size_type const end;
+        size_type const grain;
+        RangeTask const body;
+        std::atomic<size_type> pending{0};
+    };
+
+    static Worker*& currentRef() noexcept
+    {
+        static thread_local Worker* s_current = nullptr;
+        return s_current;
+    }
+    // The worker of this executor running on this thread, if any.
+    Worker* current() const noexcept
+    {
+        Worker* w = currentRef();
+        return w && w->owner == this ? w : nullptr;
+    }
+
+    // Own deque first, then the shared queue, then steal.
+    bool findTask(Worker* self, unsigned start, Task& t)
+    {
+        if (self && self->deque.take(t))
+            return taken();
+        if (m_injectSize.load(std::memory_order_relaxed) != 0 &&
+            takeInjected(self, t))
+            return taken();
+        size_type const n = m_workers.size();
+        for (size_type i = 1; i <= n; ++i)
+        {
+            Worker* victim = m_workers[(start + i) % n].get();
+            if (victim != self && victim->deque.steal(t))
+                return taken();
+        }
+        return false;
+    }
+
+    bool taken() noexcept
+    {
+        m_queued.fetch_sub(1);
+        return true;
+    }
+
+    /**
+     * Take the oldest task, move a batch of the following ones to the own
+     * deque. They are pushed newest first, so the owner takes them from
+     * the bottom in submission order.
+     */
+    bool takeInjected(Worker* self, Task& t)
+    {
+        std::lock_guard<std::mutex> lock{m_injectMutex};
+        size_type size = m_injectSize.load(std::memory_order_relaxed);
+        if (size == 0)
+            return false;
+        size_type share = 1;
+        if (self)
+        {
+            share = size / m_workers.size() + 1;
+            size_type const room = self->deque.room() + 1;
+            share = share < size ? share : size;
+            share = share < room ? share : room;
+        }
+        t = m_inject[m_injectHead];
+        for (size_type i = share - 1; i > 0; --i)
+            self->deque.push(m_inject[(m_injectHead + i) & m_injectMask]);
+        m_injectHead = (m_injectHead + share) & m_injectMask;
+        m_injectSize.store(size - share, std::memory_order_relaxed);
+        return true;
+    }
+
+    static size_type roundUp(size_type n) noexcept
+    {
+        size_type cap = 1;
+        while (cap < n)
+            cap <<= 1;
+        return cap;
+    }
+
+    void wake(size_type n)
+    {
+        if (n == 0 || m_sleepers.load() == 0)
+            return;
+        std::lock_guard<std::mutex> lock{m_sleepMutex};
+        if (n == 1)
+            m_wake.notify_one();
+        else
+            m_wake.notify_all();
+    }
+
+    void run(unsigned index)
+    {
+        Worker* self = m_workers[index].get();
+        self->index = index;
+        self->owner = this;
+        currentRef() = self;
+
+        Task t;
+        unsigned idle = 0;
+        // Stop when asked to and all tasks are taken.
+        while (!m_stop.load() || m_queued.load() != 0)
+        {
+            if (findTask(self, index, t))
+            {
+                t();
+                idle = 0;
+            }
+            else if (++idle < 64)
+                std::this_thread::yield();
+            else
+            {
+                std::unique_lock<std::mutex> lock{m_sleepMutex};
+                m_sleepers.fetch_add(1);
+                // Bounded wait, also a safety net for a missed wakeup.
+                m_wake.wait_for(lock, std::chrono::milliseconds(10), [this] {
+                    return m_queued.load() != 0 || m_stop.load();
+                });
+                m_sleepers.fetch_sub(1);
+                idle = 0;
+            }
+        }
+        currentRef() = nullptr;
+    }
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    // FIFO ring of external submissions, guarded by 'm_injectMutex'. The
+    // size is also read without the lock as a hint.
+    std::mutex m_injectMutex;
+    size_type m_injectMask;
+    std::unique_ptr<Task[]> m_inject;
+    size_type m_injectHead = 0;
+    std::atomic<size_type> m_injectSize{0};
+
+    // Number of submitted tasks not yet taken.
+    std::atomic<size_type> m_queued{0};
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<unsigned> m_sleepers{0};
+    std::atomic<bool> m_stop{false};
+};
+
+#endif /* DELEGATE_EXECUTOR_HPP_ */
@@ -0,0 +1,473 @@
+/*
+ * flat_delegate_set.hpp
+ *
+ * Fixed capacity sorted set of delegates in contiguous storage.
+ */
+
+#ifndef DELEGATE_FLAT_DELEGATE_SET_HPP_
+#define DELEGATE_FLAT_DELEGATE_SET_HPP_
+
+/**
+ * A std::set<delegate, delegate::Less> allocates one node per delegate and
+ * iterating it to call the delegates chase pointers between the nodes.
+ * flat_delegate_set keeps the delegates in one sorted array instead,
+ * ordered by 'delegate::less':
+ *
+ *   flat_delegate_set<void(Event const&), 64> subscribers;
+ *   subscribers.insert(delegate<void(Event const&)>::make<Log, &Log::on>(log));
+ *   subscribers.invoke_all(ev);
+ *   subscribers.erase(delegate<void(Event const&)>::make<Log, &Log::on>(log));
+ *
+ * - Lookup ('find', 'contains', and the search in 'insert'/'erase') is a
+ *   binary search, O(log n). Insert and erase then move the following
+ *   delegates one step, O(n) copies of two words.
+ * - Bulk insert append the new delegates, sort only them and merge them
+ *   into the stored ones in place, without extra storage. O(k log k) for k
+ *   new delegates plus the merge, instead of O(n) moves per delegate.
+ *   Filling an empty set it is as fast as one insert each for a few
+ *   hundred delegates, and faster for more.
+ * - The order is by trampoline first, so delegates to the same target
+ *   function are adjacent. 'invoke_all' then call consecutive entries via
+ *   the same branch target, as for delegate_array::sort_by_trampoline.
+ * - Each delegate is stored at most once. Null delegates are not stored.
+ *
+ * The order depend on where functions and objects are in memory. It is a
+ * valid total order within the program, but not stable between builds.
+ *
+ * Keeps the guarantees of the delegate:
+ * - Never heap allocate. Capacity N is set at compile time.
+ * - Never throw. A full set refuses new delegates by returning false.
+ *
+ * Like delegate, this header do not include anything besides delegate.hpp,
+ * so it can be included into a custom namespace together with delegate.hpp.
+ */
+
+#include "delegate.hpp"
+
+template <typename Signature, details::size_t N>
+class flat_delegate_set;
+
+/**
+ * @param R type of the return value from calling the callbacks.
+ * @param Args Argument list to the function when calling the callbacks.
+ * @param N Maximum number of delegates stored.
+ */
+template <typename R, typename... Args, details::size_t N>
+class flat_delegate_set<R(Args...), N>
+{
+  public:
+    using Delegate = delegate<R(Args...)>;
+    using size_type = details::size_t;
+    using const_iterator = Delegate const*;
+
+    constexpr flat_delegate_set() = default;
+
+    /**
+     * Call all stored delegates in sorted order. Return values are
+     * discarded.
+     */
+    void invoke_all(Args... args) const
+    {
+        for (size_type i = 0; i < m_size; ++i)
+            m_slots[i](details::pass<Args>(args)...);
+    }
+
+    /**
+     * Insert 'del' at its sorted position. O(log n) search, O(n) move.
+     * Return false, without storing anything, when full, if 'del' is null
+     * or already stored.
+     */
+    DELEGATE_CXX14CONSTEXPR bool insert(Delegate const& del) noexcept
+    {
+        if (del.null())
+            return false;
+        size_type ix = lower_bound(del);
+        if (ix < m_size && Delegate::equal(m_slots[ix], del))
+            return false;
+        if (m_size == N)
+            return false;
+        for (size_type i = m_size; i > ix; --i)
+            m_slots[i] = m_slots[i - 1];
+        m_slots[ix] = del;
+        ++m_size;
+        return true;
+    }
+
+    /**
+     * Insert 'n' delegates from 'first', sorting once. Null delegates and
+     * duplicates are skipped. Return false, without storing anything, if
+     * there is not room for the delegates left after skipping.
+     */
+    DELEGATE_CXX14CONSTEXPR bool insert(Delegate const* first,
+                                        size_type n) noexcept
+    {
+        size_type const old = m_size;
+        size_type end = old;
+        bool compacted = true;
+        for (size_type i = 0; i < n; ++i)
+        {
+            if (first[i].null())
+                continue;
+            // Out of room, drop duplicates before giving up.
+            if (end == N && !compacted)
+            {
+                end = compact(old, end);
+                compacted = true;
+            }
+            if (end == N)
+            {
+                if (has(0, old, first[i]) || has(old, end, first[i]))
+                    continue;
+                clear(old, end);
+                return false;
+            }
+            m_slots[end++] = first[i];
+            compacted = false;
+        }
+        end = compact(old, end);
+        merge(0, old, end);
+        m_size = end;
+        return true;
+    }
+
+    /**
+     * Remove 'del'. O(log n) search, O(n) move.
+     * Return false if 'del' was not found.
+     */
+    DELEGATE_CXX14CONSTEXPR bool erase(Delegate const& del) noexcept
+    {
+        size_type ix = lower_bound(del);
+        if (ix == m_size || !Delegate::equal(m_slots[ix], del))
+            return false;
+        --m_size;
+        for (size_type i = ix; i < m_size; ++i)
+            m_slots[i] = m_slots[i + 1];
+        m_slots[m_size].clear();
+        return true;
+    }
+
+    // The stored delegate equal to 'del', or end().
+    DELEGATE_CXX14CONSTEXPR const_iterator find(Delegate const& del) const
+        noexcept
+    {
+        size_type ix = lower_bound(del);
+        return ix < m_size && Delegate::equal(m_slots[ix], del) ? begin() + ix
+                                                                : end();
+    }
+
+    DELEGATE_CXX14CONSTEXPR bool contains(Delegate const& del) const noexcept
+    {
+        return find(del) != end();
+    }
+
+    DELEGATE_CXX14CONSTEXPR void clear() noexcept
+    {
+        for (size_type i = 0; i < m_size; ++i)
+            m_slots[i].clear();
+        m_size = 0;
+    }
+
+    constexpr size_type size() const noexcept
+    {
+        return m_size;
+    }
+    static constexpr size_type capacity() noexcept
+    {
+        return N;
+    }
+    constexpr bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+    constexpr bool full() const noexcept
+    {
+        return m_size == N;
+    }
+
+    constexpr Delegate const& operator[](size_type ix) const noexcept
+    {
+        return m_slots[ix];
+    }
+    constexpr const_iterator begin() const noexcept
+    {
+        return m_slots;
+    }
+    constexpr const_iterator end() const noexcept
+    {
+        return m_slots + m_size;
+    }
+
+  private:
+    // First position not less than 'del'.
+    DELEGATE_CXX14CONSTEXPR size_type lower_bound(Delegate const& del) const
+        noexcept
+    {
+        return lowerBound(0, m_size, del);
+    }
+
+    // First position in [lo, hi) not less than 'del'.
+    DELEGATE_CXX14CONSTEXPR size_type lowerBound(size_type lo, size_type hi,
+                                                 Delegate const& del) const
+        noexcept
+    {
+        while (lo < hi)
+        {
+            size_type mid = lo + (hi - lo) / 2;
+            if (Delegate::less(m_slots[mid], del))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // First position in [lo, hi) greater than 'del'.
+    DELEGATE_CXX14CONSTEXPR size_type upperBound(size_type lo, size_type hi,
+                                                 Delegate const& del) const
+        noexcept
+    {
+        while (lo < hi)
+        {
+            size_type mid = lo + (hi - lo) / 2;
+            if (Delegate::less(del, m_slots[mid]))
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        return lo;
+    }
+
+    // If the sorted range [lo, hi) holds 'del'.
+    DELEGATE_CXX14CONSTEXPR bool has(size_type lo, size_type hi,
+                                     Delegate const& del) const noexcept
+    {
+        size_type const ix = lowerBound(lo, hi, del);
+        return ix < hi && Delegate::equal(m_slots[ix], del);
+    }
+
+    DELEGATE_CXX14CONSTEXPR void clear(size_type lo, size_type hi) noexcept
+    {
+        for (size_type i = lo; i < hi; ++i)
+            m_slots[i].clear();
+    }
+
+    /**
+     * Sort the new delegates in [lo, hi), drop duplicates and those already
+     * in [0, lo). Return the new end.
+     */
+    DELEGATE_CXX14CONSTEXPR size_type compact(size_type lo,
+                                              size_type hi) noexcept
+    {
+        sort(lo, hi);
+        size_type out = lo;
+        // Sorted, so each search starts where the previous ended.
+        size_type from = 0;
+        for (size_type i = lo; i < hi; ++i)
+        {
+            if (out > lo && Delegate::equal(m_slots[i], m_slots[out - 1]))
+                continue;
+            from = lowerBound(from, lo, m_slots[i]);
+            if (from == lo || !Delegate::equal(m_slots[from], m_slots[i]))
+                m_slots[out++] = m_slots[i];
+        }
+        clear(out, hi);
+        return out;
+    }
+
+    /**
+     * Introsort of [lo, hi): quicksort down to small partitions, heap sort
+     * if it recurse too deep, then one insertion sort pass.
+     */
+    DELEGATE_CXX14CONSTEXPR void sort(size_type lo, size_type hi) noexcept
+    {
+        size_type depth = 0;
+        for (size_type n = hi - lo; n > 1; n >>= 1)
+            depth += 2;
+        quickSort(lo, hi, depth);
+        insertionSort(lo, hi);
+    }
+
+    DELEGATE_CXX14CONSTEXPR void quickSort(size_type lo, size_type hi,
+                                           size_type depth) noexcept
+    {
+        while (hi - lo > 16)
+        {
+            if (depth == 0)
+            {
+                heapSort(lo, hi);
+                return;
+            }
+            --depth;
+            size_type const cut = partition(lo, hi);
+            quickSort(cut, hi, depth);
+            hi = cut;
+        }
+    }
+
+    // Median of three as pivot at 'lo', then partition around it.
+    DELEGATE_CXX14CONSTEXPR size_type partition(size_type lo,
+                                                size_type hi) noexcept
+    {
+        size_type const a = lo + 1;
+        size_type const b = lo + (hi - lo) / 2;
+        size_type const c = hi - 1;
+        if (less(a, b))
+        {
+            if (less(b, c))
+                swap(lo, b);
+            else if (less(a, c))
+                swap(lo, c);
+            else
+                swap(lo, a);
+        }
+        else if (less(a, c))
+            swap(lo, a);
+        else if (less(b, c))
+            swap(lo, c);
+        else
+            swap(lo, b);
+
+        // The pivot and the median candidates bound both scans.
+        size_type i = lo + 1;
+        size_type j = hi;
+        for (;;)
+        {
+            while (less(i, lo))
+                ++i;
+            --j;
+            while (less(lo, j))
+                --j;
+            if (i >= j)
+                return i;
+            swap(i, j);
+            ++i;
+        }
+    }
+
+    DELEGATE_CXX14CONSTEXPR void insertionSort(size_type lo,
+                                               size_type hi) noexcept
+    {
+        for (size_type i = lo + 1; i < hi; ++i)
+        {
+            Delegate const d = m_slots[i];
+            size_type j = i;
+            for (; j > lo && Delegate::less(d, m_slots[j - 1]); --j)
+                m_slots[j] = m_slots[j - 1];
+            m_slots[j] = d;
+        }
+    }
+
+    // In place heap sort of [lo, hi), O(n log n), no extra storage.
+    DELEGATE_CXX14CONSTEXPR void heapSort(size_type lo, size_type hi) noexcept
+    {
+        size_type const n = hi - lo;
+        for (size_type i = n / 2; i > 0; --i)
+            siftDown(lo, i - 1, n);
+        for (size_type end = n; end > 1; --end)
+        {
+            swap(lo, lo + end - 1);
+            siftDown(lo, 0, end - 1);
+        }
+    }
+
+    DELEGATE_CXX14CONSTEXPR void siftDown(size_type base, size_type root,
+                                          size_type end) noexcept
+    {
+        for (;;)
+        {
+            size_type child = 2 * root + 1;
+            if (child >= end)
+                return;
+            if (child + 1 < end && less(base + child, base + child + 1))
+                ++child;
+            if (!less(base + root, base + child))
+                return;
+            swap(base + root, base + child);
+            root = child;
+        }
+    }
+
+    /**
+     * Merge the sorted ranges [lo, mid) and [mid, hi) in place, by
+     * rotations. A short range is instead moved into place one delegate at
+     * a time. No moves if the second range sort after the first.
+     */
+    DELEGATE_CXX14CONSTEXPR void merge(size_type lo, size_type mid,
+                                       size_type hi) noexcept
+    {
+        if (lo == mid || mid == hi || !less(mid, mid - 1))
+            return;
+        if (hi - mid <= 16)
+        {
+            for (size_type i = mid; i < hi; ++i)
+            {
+                Delegate const d = m_slots[i];
+                size_type j = i;
+                for (lo = upperBound(lo, i, d); j > lo; --j)
+                    m_slots[j] = m_slots[j - 1];
+                m_slots[j] = d;
+            }
+            return;
+        }
+        if (mid - lo <= 16)
+        {
+            for (size_type i = mid; i-- > lo;)
+            {
+                Delegate const d = m_slots[i];
+                size_type j = i;
+                for (hi = lowerBound(i + 1, hi, d); j + 1 < hi; ++j)
+                    m_slots[j] = m_slots[j + 1];
+                m_slots[j] = d;
+            }
+            return;
+        }
+        size_type cut1 = lo;
+        size_type cut2 = mid;
+        if (mid - lo > hi - mid)
+        {
+            cut1 = lo + (mid - lo) / 2;
+            cut2 = lowerBound(mid, hi, m_slots[cut1]);
+        }
+        else
+        {
+            cut2 = mid + (hi - mid) / 2;
+            cut1 = upperBound(lo, mid, m_slots[cut2]);
+        }
+        size_type const newMid = cut1 + (cut2 - mid);
+        rotate(cut1, mid, cut2);
+        merge(lo, cut1, newMid);
+        merge(newMid, cut2, hi);
+    }
+
+    // Move [mid, hi) before [lo, mid).
+    DELEGATE_CXX14CONSTEXPR void rotate(size_type lo, size_type mid,
+                                        size_type hi) noexcept
+    {
+        reverse(lo, mid);
+        reverse(mid, hi);
+        reverse(lo, hi);
+    }
+
+    DELEGATE_CXX14CONSTEXPR void reverse(size_type lo, size_type hi) noexcept
+    {
+        for (; lo + 1 < hi; ++lo, --hi)
+            swap(lo, hi - 1);
+    }
+
+    DELEGATE_CXX14CONSTEXPR bool less(size_type a, size_type b) const noexcept
+    {
+        return Delegate::less(m_slots[a], m_slots[b]);
+    }
+
+    DELEGATE_CXX14CONSTEXPR void swap(size_type a, size_type b) noexcept
+    {
+        Delegate d = m_slots[a];
+        m_slots[a] = m_slots[b];
+        m_slots[b] = d;
+    }
+
+    Delegate m_slots[N] = {};
+    size_type m_size = 0;
+};
+
+#endif /* DELEGATE_FLAT_DELEGATE_SET_HPP_ */
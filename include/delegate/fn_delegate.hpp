@@ -0,0 +1,215 @@
+/*
+ * fn_delegate.hpp
+ *
+ * One pointer wide delegate, only for free functions.
+ */
+
+#ifndef DELEGATE_FN_DELEGATE_HPP_
+#define DELEGATE_FN_DELEGATE_HPP_
+
+/**
+ * A delegate always store 2 pointers, even when calling a free function
+ * which has no use of the data pointer. fn_delegate stores only the
+ * function pointer, for tables with lots of callbacks to free functions or
+ * stateless lambdas.
+ *
+ * - Same null semantics as delegate. A null fn_delegate point to an
+ *   internal function returning a value initialized R, so a call never
+ *   need to test for null.
+ * - Converts implicitly to a delegate calling the same function. A null
+ *   fn_delegate is converted to a null delegate.
+ * - No heap allocation, no exceptions, trivially copyable.
+ *
+ * A call is a direct call through the stored pointer without passing any
+ * trampoline. Note that a delegate converted from a fn_delegate use the
+ * runtime function pointer trampoline. It will compare equal to a delegate
+ * created with 'delegate(fkn)', not to one created with 'make<fkn>()'.
+ *
+ * Like delegate, this header do not include anything besides delegate.hpp,
+ * so it can be included into a custom namespace together with delegate.hpp.
+ */
+
+#include "delegate.hpp"
+
+template <typename Signature>
+class fn_delegate;
+
+/**
+ * @param R type of the return value from calling the callback.
+ * @param Args Argument list to the function when calling the callback.
+ */
+template <typename R, typename... Args>
+class fn_delegate<R(Args...)>
+{
+  public:
+    using Delegate = delegate<R(Args...)>;
+    using FknPtr = R (*)(Args...);
+
+    // Default construct to null state.
+    constexpr fn_delegate() = default;
+    constexpr fn_delegate(details::nullptr_t) noexcept {}
+
+    // Accept function pointers and stateless lambdas. A null pointer give
+    // the null state.
+    constexpr fn_delegate(FknPtr fkn) noexcept
+        : m_fkn(fkn ? fkn : &doNull)
+    {
+    }
+
+    ~fn_delegate() = default;
+
+    template <R (*fkn)(Args...)>
+    static constexpr fn_delegate make() noexcept
+    {
+        return fn_delegate{fkn};
+    }
+
+    template <R (*fkn)(Args...)>
+    DELEGATE_CXX14CONSTEXPR fn_delegate& set() noexcept
+    {
+        m_fkn = fkn;
+        return *this;
+    }
+
+    DELEGATE_CXX14CONSTEXPR fn_delegate& set(FknPtr fkn) noexcept
+    {
+        m_fkn = fkn ? fkn : &doNull;
+        return *this;
+    }
+
+    DELEGATE_CXX14CONSTEXPR fn_delegate& operator=(details::nullptr_t) noexcept
+    {
+        clear();
+        return *this;
+    }
+
+    // Call the stored function. Valid to call in null state.
+    DELEGATE_ALWAYS_INLINE R operator()(Args... args) const
+    {
+        return m_fkn(details::fwd<Args>(args)...);
+    }
+
+    // A delegate calling the same function.
+    constexpr operator Delegate() const noexcept
+    {
+        return null() ? Delegate{} : Delegate{m_fkn};
+    }
+
+    constexpr bool null() const noexcept
+    {
+        return m_fkn == &doNull;
+    }
+    constexpr explicit operator bool() const noexcept
+    {
+        return !null();
+    }
+
+    DELEGATE_CXX14CONSTEXPR void clear() noexcept
+    {
+        m_fkn = &doNull;
+    }
+
+    // Return the stored function, nullptr when in null state.
+    constexpr FknPtr get() const noexcept
+    {
+        return null() ? nullptr : m_fkn;
+    }
+
+    static constexpr bool equal(fn_delegate const& lhs,
+                                fn_delegate const& rhs) noexcept
+    {
+        return lhs.m_fkn == rhs.m_fkn;
+    }
+
+    static constexpr bool less(fn_delegate const& lhs,
+                               fn_delegate const& rhs) noexcept
+    {
+        return (lhs.null() && !rhs.null()) ||
+               (!rhs.null() && lhs.m_fkn < rhs.m_fkn);
+    }
+
+    static details::size_t hash(fn_delegate const& d) noexcept
+    {
+        return details::hashFkn(d.m_fkn);
+    }
+
+    struct Equal
+    {
+        constexpr bool operator()(fn_delegate const& lhs,
+                                  fn_delegate const& rhs) const noexcept
+        {
+            return equal(lhs, rhs);
+        }
+    };
+
+    struct Less
+    {
+        constexpr bool operator()(fn_delegate const& lhs,
+                                  fn_delegate const& rhs) const noexcept
+        {
+            return less(lhs, rhs);
+        }
+    };
+
+    struct Hash
+    {
+        details::size_t operator()(fn_delegate const& d) const noexcept
+        {
+            return hash(d);
+        }
+    };
+
+  private:
+    static R doNull(Args...)
+    {
+        return details::nullReturnFunction<R>();
+    }
+
+    FknPtr m_fkn = &doNull;
+};
+
+template <typename R, typename... Args>
+constexpr bool
+operator==(fn_delegate<R(Args...)> const& lhs,
+           fn_delegate<R(Args...)> const& rhs) noexcept
+{
+    return fn_delegate<R(Args...)>::equal(lhs, rhs);
+}
+
+template <typename R, typename... Args>
+constexpr bool
+operator!=(fn_delegate<R(Args...)> const& lhs,
+           fn_delegate<R(Args...)> const& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+template <typename R, typename... Args>
+constexpr bool
+operator==(fn_delegate<R(Args...)> const& lhs, details::nullptr_t) noexcept
+{
+    return lhs.null();
+}
+
+template <typename R, typename... Args>
+constexpr bool
+operator==(details::nullptr_t, fn_delegate<R(Args...)> const& rhs) noexcept
+{
+    return rhs.null();
+}
+
+template <typename R, typename... Args>
+constexpr bool
+operator!=(fn_delegate<R(Args...)> const& lhs, details::nullptr_t) noexcept
+{
+    return !lhs.null();
+}
+
+template <typename R, typename... Args>
+constexpr bool
+operator!=(details::nullptr_t, fn_delegate<R(Args...)> const& rhs) noexcept
+{
+    return !rhs.null();
+}
+
+#endif /* DELEGATE_FN_DELEGATE_HPP_ */
@@ -0,0 +1,67 @@
+/*
+ * hash.hpp
+ *
+ * std::hash specializations for delegate and mem_fkn.
+ */
+
+#ifndef DELEGATE_HASH_HPP_
+#define DELEGATE_HASH_HPP_
+
+/**
+ * Allow delegate and mem_fkn to be used as keys in std::unordered_set,
+ * std::unordered_map et.al. without supplying a hash functor.
+ *
+ * The hash values are consistent with 'equal', i.e. equal objects give
+ * equal hash values. Just as for 'less' the values depend on where the
+ * linker put the symbols, so they are not stable between builds.
+ *
+ * This header must be included in the global namespace since it
+ * specializes std::hash. If delegate.hpp was included into some other
+ * namespace, define DELEGATE_NAMESPACE to that namespace name before
+ * including this file. E.g:
+ *
+ *   namespace my_ns {
+ *   #include "delegate/delegate.hpp"
+ *   }
+ *   #define DELEGATE_NAMESPACE my_ns
+ *   #include "delegate/hash.hpp"
+ *
+ * The delegate members 'Hash' can be used directly without this header.
+ */
+
+#include "delegate.hpp"
+
+#include <cstddef>
+#include <functional>
+
+#ifndef DELEGATE_NAMESPACE
+#define DELEGATE_NAMESPACE
+#endif
+
+namespace std
+{
+
+template <typename Signature>
+struct hash<DELEGATE_NAMESPACE::delegate<Signature>>
+{
+    size_t operator()(
+        DELEGATE_NAMESPACE::delegate<Signature> const& d) const noexcept
+    {
+        return DELEGATE_NAMESPACE::delegate<Signature>::hash(d);
+    }
+};
+
+template <typename T, bool cnst, typename Signature>
+struct hash<DELEGATE_NAMESPACE::mem_fkn<T, cnst, Signature>>
+{
+    size_t operator()(
+        DELEGATE_NAMESPACE::mem_fkn<T, cnst, Signature> const& mf) const
+        noexcept
+    {
+        return DELEGATE_NAMESPACE::mem_fkn<T, cnst, Signature>::hash(mf);
+    }
+};
+
+} // namespace std
+
+#endif /* DELEGATE_HASH_HPP_ */
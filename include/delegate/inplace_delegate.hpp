@@ -0,0 +1,209 @@
+/*
+ * inplace_delegate.hpp
+ *
+ * Owning delegate, storing the functor in an inline buffer.
+ */
+
+#ifndef DELEGATE_INPLACE_DELEGATE_HPP_
+#define DELEGATE_INPLACE_DELEGATE_HPP_
+
+/**
+ * The delegate only stores a pointer to functors, so a capturing lambda
+ * must be kept alive elsewhere. inplace_delegate instead stores a copy of
+ * the functor in an inline buffer of 'Capacity' bytes.
+ *
+ * - No heap allocation. Functors not fitting the buffer fail to compile.
+ * - No exceptions.
+ * - Only trivially copyable and trivially destructible functors are
+ *   accepted (e.g. lambdas capturing pointers, references and PODs). Hence
+ *   the inplace_delegate itself is always trivially copyable and can be
+ *   memcpy:d like a delegate.
+ *
+ * It use the same trampoline functions as delegate. The stored trampoline
+ * is called with a data pointer to the internal buffer. The 'view' member
+ * returns a plain delegate referring to the stored functor. The view is only
+ * valid as long as the inplace_delegate is alive and not modified.
+ *
+ * A call to a const inplace_delegate will call a non-const operator() on
+ * the stored functor, same as std::function. The inplace_delegate owns the
+ * functor, const of the inplace_delegate does not propagate.
+ */
+
+#include "delegate.hpp"
+
+#include <new>
+#include <type_traits>
+
+template <typename Signature, details::size_t Capacity = 2 * sizeof(void*),
+          details::size_t Align = alignof(void*)>
+class inplace_delegate;
+
+/**
+ * @param R type of the return value from calling the callback.
+ * @param Args Argument list to the function when calling the callback.
+ * @param Capacity Size of the inline buffer in bytes.
+ * @param Align Alignment of the inline buffer.
+ */
+template <typename R, typename... Args, details::size_t Capacity,
+          details::size_t Align>
+class inplace_delegate<R(Args...), Capacity, Align>
+{
+  public:
+    using Delegate = delegate<R(Args...)>;
+    using common = typename Delegate::common;
+    using DataPtr = typename Delegate::DataPtr;
+    using Trampoline = typename Delegate::Trampoline;
+    using FknPtr = typename Delegate::FknPtr;
+
+    // True if a functor of type F can be stored.
+    template <class F>
+    struct can_store
+        : std::integral_constant<bool,
+                                 sizeof(F) <= Capacity && alignof(F) <= Align &&
+                                     std::is_trivially_copyable<F>::value &&
+                                     std::is_trivially_destructible<F>::value>
+    {
+    };
+
+  private:
+    template <class F>
+    using EnableFunctor = typename std::enable_if<
+        !std::is_same<typename std::decay<F>::type, inplace_delegate>::value &&
+            !std::is_same<typename std::decay<F>::type,
+                          details::nullptr_t>::value,
+        int>::type;
+
+  public:
+    // Default construct to null state.
+    constexpr inplace_delegate() = default;
+    constexpr inplace_delegate(details::nullptr_t) noexcept {}
+
+    // Store a copy of the functor f. Accept temporaries as well.
+    template <class F, EnableFunctor<F> = 0>
+    inplace_delegate(F const& f) noexcept
+    {
+        store(f);
+    }
+
+    ~inplace_delegate() = default;
+
+    template <class F>
+    static inplace_delegate make(F const& f) noexcept
+    {
+        return inplace_delegate{f};
+    }
+
+    // Free function, nothing to store in the buffer.
+    template <R (*fkn)(Args...)>
+    static inplace_delegate make() noexcept
+    {
+        inplace_delegate res;
+        res.m_fkn = &Delegate::template doFreeCB<fkn>;
+        return res;
+    }
+
+    template <class F>
+    inplace_delegate& set(F const& f) noexcept
+    {
+        store(f);
+        return *this;
+    }
+
+    template <R (*fkn)(Args...)>
+    inplace_delegate& set() noexcept
+    {
+        m_fkn = &Delegate::template doFreeCB<fkn>;
+        return *this;
+    }
+
+    inplace_delegate& operator=(details::nullptr_t) noexcept
+    {
+        clear();
+        return *this;
+    }
+
+    // Call the stored functor. Valid to call in null state.
+    DELEGATE_ALWAYS_INLINE R operator()(Args... args) const
+    {
+        return m_fkn(DataPtr{const_cast<unsigned char*>(m_buf)},
+                     details::fwd<Args>(args)...);
+    }
+
+    // Return a non owning delegate calling the stored functor.
+    Delegate view() const& noexcept
+    {
+        return Delegate{m_fkn, const_cast<unsigned char*>(m_buf)};
+    }
+    // View of a temporary would dangle.
+    Delegate view() const&& = delete;
+
+    constexpr bool null() const noexcept
+    {
+        return m_fkn == &common::doNullCB;
+    }
+    constexpr explicit operator bool() const noexcept
+    {
+        return !null();
+    }
+
+    void clear() noexcept
+    {
+        m_fkn = &common::doNullCB;
+    }
+
+  private:
+    template <class F>
+    void store(F const& f) noexcept
+    {
+        static_assert(sizeof(F) <= Capacity,
+                      "Functor too large for inplace_delegate Capacity");
+        static_assert(alignof(F) <= Align,
+                      "Functor alignment larger than inplace_delegate Align");
+        static_assert(std::is_trivially_copyable<F>::value &&
+                          std::is_trivially_destructible<F>::value,
+                      "inplace_delegate require trivially copyable functors");
+        ::new (static_cast<void*>(m_buf)) F(f);
+        m_fkn = Delegate::template FunctorTrampoline<F>::value;
+    }
+
+    void store(FknPtr f) noexcept
+    {
+        if (f)
+            store<FknPtr>(f);
+        else
+            clear();
+    }
+
+    Trampoline m_fkn = &common::doNullCB;
+    alignas(Align) unsigned char m_buf[Capacity] = {};
+};
+
+template <typename S, details::size_t C, details::size_t A>
+bool
+operator==(inplace_delegate<S, C, A> const& lhs, details::nullptr_t) noexcept
+{
+    return lhs.null();
+}
+
+template <typename S, details::size_t C, details::size_t A>
+bool
+operator==(details::nullptr_t, inplace_delegate<S, C, A> const& rhs) noexcept
+{
+    return rhs.null();
+}
+
+template <typename S, details::size_t C, details::size_t A>
+bool
+operator!=(inplace_delegate<S, C, A> const& lhs, details::nullptr_t) noexcept
+{
+    return !lhs.null();
+}
+
+template <typename S, details::size_t C, details::size_t A>
+bool
+operator!=(details::nullptr_t, inplace_delegate<S, C, A> const& rhs) noexcept
+{
+    return !rhs.null();
+}
+
+#endif /* DELEGATE_INPLACE_DELEGATE_HPP_ */
@@ -0,0 +1,328 @@
+/*
+ * instrumentation.hpp
+ *
+ * Opt-in call counts and latency histograms per delegate target.
+ */
+
+#ifndef DELEGATE_INSTRUMENTATION_HPP_
+#define DELEGATE_INSTRUMENTATION_HPP_
+
+/**
+ * Find hot and slow callbacks in a running program. Use
+ * instrumented_delegate<Signature> in place of delegate<Signature> where
+ * calls should be measured:
+ *
+ *   instrumented_delegate<void(Msg const&)> m_onMsg;
+ *   ...
+ *   delegate_stats::global().dump(std::cerr);
+ *
+ * When DELEGATE_INSTRUMENT is defined to 1, instrumented_delegate is a
+ * delegate whose call operator records the number of calls and the call
+ * latency in nanoseconds for the called target. Otherwise (the default)
+ * instrumented_delegate is an alias for delegate, so the generated code is
+ * exactly that of delegate.
+ *
+ * A target is identified by the trampoline and the data pointer, i.e. the
+ * function and the object it is called on. The statistics are kept in a
+ * fixed size, lock-free, open addressing table. Recording a call does a
+ * lookup in the table and a few relaxed atomic increments. When the table
+ * is full, calls to new targets are only counted as dropped.
+ *
+ * Latency is recorded in a histogram with power of 2 buckets. Bucket 'i'
+ * count calls taking [2^i, 2^(i+1)) ns, bucket 0 also those below 1 ns.
+ *
+ * The recording is done by the call operator of instrumented_delegate,
+ * the trampolines are the same as for delegate. Hence a copy sliced to a
+ * plain delegate, e.g. passed as 'delegate const&' or stored in a
+ * multicast_delegate, is not recorded. Likewise the static 'make'
+ * functions return a plain delegate, assign the result to an
+ * instrumented_delegate to keep the instrumentation.
+ */
+
+#include "delegate.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <thread>
+
+#ifndef DELEGATE_INSTRUMENT
+#define DELEGATE_INSTRUMENT 0
+#endif
+
+// Number of targets which can be recorded. Must be a power of 2.
+#ifndef DELEGATE_INSTRUMENT_SLOTS
+#define DELEGATE_INSTRUMENT_SLOTS 1024
+#endif
+
+// Snapshot of the statistics for one target.
+struct delegate_call_stats
+{
+    static constexpr unsigned buckets = 32;
+
+    std::uintptr_t trampoline;
+    std::uintptr_t data;
+    std::uint64_t calls;
+    std::uint64_t total_ns;
+    std::uint64_t histogram[buckets];
+};
+
+/**
+ * Registry of call statistics. Normally only the instance returned by
+ * 'global' is used.
+ */
+class delegate_stats
+{
+  public:
+    using size_type = details::size_t;
+    static constexpr size_type slots = DELEGATE_INSTRUMENT_SLOTS;
+    static_assert(slots > 0 && (slots & (slots - 1)) == 0,
+                  "DELEGATE_INSTRUMENT_SLOTS must be a power of 2");
+
+    delegate_stats() = default;
+    delegate_stats(delegate_stats const&) = delete;
+    delegate_stats& operator=(delegate_stats const&) = delete;
+
+    static delegate_stats& global() noexcept
+    {
+        static delegate_stats s_stats;
+        return s_stats;
+    }
+
+    // Record one call to the target 'trampoline', 'data' taking 'ns'.
+    void record(std::uintptr_t trampoline, std::uintptr_t data,
+                std::uint64_t ns) noexcept
+    {
+        Slot* s = find(trampoline, data);
+        if (!s)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        s->calls.fetch_add(1, std::memory_order_relaxed);
+        s->total_ns.fetch_add(ns, std::memory_order_relaxed);
+        s->histogram[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Record a call to delegate 'd'.
+    template <typename Delegate>
+    void record(Delegate const& d, std::uint64_t ns) noexcept
+    {
+        record(reinterpret_cast<std::uintptr_t>(d.trampoline()),
+               dataWord(d.data()), ns);
+    }
+
+    /**
+     * Call 'f(delegate_call_stats const&)' for each recorded target.
+     * Counters updated concurrently may be seen partially updated.
+     */
+    template <typename F>
+    void for_each(F&& f) const
+    {
+        for (Slot const& s : m_slots)
+        {
+            if (s.state.load(std::memory_order_acquire) != ready)
+                continue;
+            delegate_call_stats st;
+            st.trampoline = s.trampoline;
+            st.data = s.data;
+            st.calls = s.calls.load(std::memory_order_relaxed);
+            st.total_ns = s.total_ns.load(std::memory_order_relaxed);
+            for (unsigned i = 0; i < delegate_call_stats::buckets; ++i)
+                st.histogram[i] = s.histogram[i].load(std::memory_order_relaxed);
+            f(st);
+        }
+    }
+
+    /**
+     * Write one line per target: trampoline and data pointer, number of
+     * calls, mean latency and the non empty histogram buckets.
+     */
+    void dump(std::ostream& os) const
+    {
+        for_each([&os](delegate_call_stats const& st) {
+            os << "trampoline=0x" << std::hex << st.trampoline << " data=0x"
+               << st.data << std::dec << " calls=" << st.calls << " mean_ns="
+               << (st.calls ? st.total_ns / st.calls : 0) << " hist=";
+            for (unsigned i = 0; i < delegate_call_stats::buckets; ++i)
+            {
+                if (st.histogram[i])
+                    os << '[' << (i ? (std::uint64_t{1} << i) : 0)
+                       << "ns]:" << st.histogram[i] << ' ';
+            }
+            os << '\n';
+        });
+        os << "dropped=" << dropped() << '\n';
+    }
+
+    // Number of calls not recorded since the table was full.
+    std::uint64_t dropped() const noexcept
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    // Zero all counters. The recorded targets are kept.
+    void reset() noexcept
+    {
+        for (Slot& s : m_slots)
+        {
+            s.calls.store(0, std::memory_order_relaxed);
+            s.total_ns.store(0, std::memory_order_relaxed);
+            for (auto& h : s.histogram)
+                h.store(0, std::memory_order_relaxed);
+        }
+        m_dropped.store(0, std::memory_order_relaxed);
+    }
+
+    // Bucket of a latency, the index of the highest set bit.
+    static unsigned bucketOf(std::uint64_t ns) noexcept
+    {
+        unsigned b = 0;
+        while (ns >>= 1)
+            ++b;
+        return b < delegate_call_stats::buckets
+                   ? b
+                   : delegate_call_stats::buckets - 1;
+    }
+
+    // The data pointer as an integer, whichever union member is active.
+    template <typename DataPtr>
+    static std::uintptr_t dataWord(DataPtr const& d) noexcept
+    {
+        static_assert(sizeof(DataPtr) == sizeof(std::uintptr_t),
+                      "DataPtr expected to be one word");
+        std::uintptr_t w;
+        std::memcpy(&w, &d, sizeof w);
+        return w;
+    }
+
+  private:
+    enum : unsigned
+    {
+        empty = 0,
+        writing = 1,
+        ready = 2
+    };
+
+    struct Slot
+    {
+        std::atomic<unsigned> state{empty};
+        // Written once, before 'state' is set to ready.
+        std::uintptr_t trampoline = 0;
+        std::uintptr_t data = 0;
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> total_ns{0};
+        std::atomic<std::uint64_t> histogram[delegate_call_stats::buckets] =
+            {};
+    };
+
+    // Find or claim the slot for a target. Null if the table is full.
+    Slot* find(std::uintptr_t trampoline, std::uintptr_t data) noexcept
+    {
+        std::uint64_t h = (trampoline ^ (data * 0x9e3779b97f4a7c15u));
+        h ^= h >> 29;
+        for (size_type n = 0; n < slots; ++n)
+        {
+            Slot& s = m_slots[(h + n) & (slots - 1)];
+            unsigned st = s.state.load(std::memory_order_acquire);
+            if (st == empty &&
+                s.state.compare_exchange_strong(st, writing,
+                                                std::memory_order_acquire))
+            {
+                s.trampoline = trampoline;
+                s.data = data;
+                s.state.store(ready, std::memory_order_release);
+                return &s;
+            }
+            // Another thread is claiming this slot, wait for its key.
+            while (st == writing)
+            {
+                std::this_thread::yield();
+                st = s.state.load(std::memory_order_acquire);
+            }
+            if (s.trampoline == trampoline && s.data == data)
+                return &s;
+        }
+        return nullptr;
+    }
+
+    Slot m_slots[slots];
+    std::atomic<std::uint64_t> m_dropped{0};
+};
+
+#if DELEGATE_INSTRUMENT
+
+namespace details
+{
+
+// Record the time from construction to destruction. The target is copied
+// at construction, the callee may reassign or destroy the delegate.
+class call_timer
+{
+  public:
+    template <typename Delegate>
+    explicit call_timer(Delegate const& d) noexcept
+        : m_trampoline(reinterpret_cast<std::uintptr_t>(d.trampoline())),
+          m_data(delegate_stats::dataWord(d.data())),
+          m_start(std::chrono::steady_clock::now())
+    {
+    }
+    call_timer(call_timer const&) = delete;
+    call_timer& operator=(call_timer const&) = delete;
+
+    ~call_timer()
+    {
+        auto const t = std::chrono::steady_clock::now() - m_start;
+        delegate_stats::global().record(
+            m_trampoline, m_data,
+            static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(t)
+                    .count()));
+    }
+
+  private:
+    std::uintptr_t m_trampoline;
+    std::uintptr_t m_data;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace details
+
+template <typename Signature>
+class instrumented_delegate;
+
+/**
+ * A delegate recording its calls in delegate_stats::global().
+ * @param R type of the return value from calling the callback.
+ * @param Args Argument list to the function when calling the callback.
+ */
+template <typename R, typename... Args DELEGATE_NE_TPARAM>
+class instrumented_delegate<R(Args...) DELEGATE_NE>
+    : public delegate<R(Args...) DELEGATE_NE>
+{
+  public:
+    using Delegate = delegate<R(Args...) DELEGATE_NE>;
+    using Delegate::Delegate;
+
+    constexpr instrumented_delegate() = default;
+    constexpr instrumented_delegate(Delegate const& d) noexcept : Delegate(d)
+    {
+    }
+
+    R operator()(Args... args) const DELEGATE_NE
+    {
+        details::call_timer timer{*this};
+        return Delegate::operator()(details::fwd<Args>(args)...);
+    }
+};
+
+#else
+
+template <typename Signature>
+using instrumented_delegate = delegate<Signature>;
+
+#endif
+
+#endif /* DELEGATE_INSTRUMENTATION_HPP_ */
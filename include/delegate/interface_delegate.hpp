@@ -0,0 +1,263 @@
+/*
+ * interface_delegate.hpp
+ *
+ * Several callbacks on one object, sharing the object pointer. Require C++17.
+ */
+
+#ifndef DELEGATE_INTERFACE_DELEGATE_HPP_
+#define DELEGATE_INTERFACE_DELEGATE_HPP_
+
+/**
+ * Exposing an object through several callbacks with one delegate each
+ * repeats the object pointer in every delegate. An
+ * interface_delegate<Sig0, Sig1, ...> stores the object pointer once,
+ * together with a pointer to a table of trampolines, one per signature:
+ *
+ *   using ConnIf = interface_delegate<void(Buf const&), void(Buf const&),
+ *                                     void()>;
+ *   auto d = ConnIf::make<&Conn::onRead, &Conn::onWrite, &Conn::onClose>(c);
+ *   d.call<0>(buf); // c.onRead(buf)
+ *   d.call<2>();    // c.onClose()
+ *
+ * Entries are selected by index, the same signature may occur several
+ * times. The table is a constexpr static object, generated per set of
+ * targets and placed in read-only memory (.rodata, or .data.rel.ro when
+ * relocations are needed). It holds the same trampolines as
+ * 'delegate::make', so no extra code is generated for targets also bound
+ * to plain delegates.
+ *
+ * Two words and trivially copyable, independent of the number of
+ * signatures. 'get<I>()' return a plain delegate for entry I.
+ *
+ * Const and non-const member functions can be mixed, then the object must
+ * be non-const.
+ */
+
+#include "arg_pack.hpp"
+#include "delegate.hpp"
+
+#include <type_traits>
+
+#if DELEGATE_CPP_VERSION < 201703L
+#error "interface_delegate require at least C++17"
+#endif
+
+namespace details
+{
+
+// Type number I of the signatures.
+template <size_t I, typename S, typename... Rest>
+struct signature_at : signature_at<I - 1, Rest...>
+{
+};
+template <typename S, typename... Rest>
+struct signature_at<0, S, Rest...>
+{
+    using type = S;
+};
+
+// Class of a member function pointer type.
+template <typename M>
+struct member_object;
+template <class T, typename R, typename... P, bool ne>
+struct member_object<R (T::*)(P...) noexcept(ne)>
+{
+    using type = T;
+};
+template <class T, typename R, typename... P, bool ne>
+struct member_object<R (T::*)(P...) const noexcept(ne)>
+{
+    using type = T;
+};
+
+// Class of the first member function.
+template <auto mf, auto...>
+struct first_member_object : member_object<decltype(mf)>
+{
+};
+
+} // namespace details
+
+/**
+ * @param Sigs Signatures of the callbacks, as for delegate. Entry I is
+ * called with 'call<I>'.
+ */
+template <typename... Sigs>
+class interface_delegate
+{
+    static_assert(sizeof...(Sigs) > 0,
+                  "interface_delegate require at least one signature");
+
+  public:
+    using Table = details::arg_pack<typename delegate<Sigs>::Trampoline...>;
+
+    template <details::size_t I>
+    using signature = typename details::signature_at<I, Sigs...>::type;
+
+    template <details::size_t I>
+    using delegate_type = delegate<signature<I>>;
+
+    static constexpr details::size_t size = sizeof...(Sigs);
+
+    // Null state. All entries can be called, returning a default R.
+    constexpr interface_delegate() noexcept
+        : m_obj(nullptr), m_table(&NullTable::value)
+    {
+    }
+    constexpr interface_delegate(details::nullptr_t) noexcept
+        : interface_delegate()
+    {
+    }
+
+  private:
+    template <auto... mfs>
+    using object_of = typename details::first_member_object<mfs...>::type;
+
+    template <typename Sig, auto mf>
+    using Deduce =
+        typename details::common<Sig>::template DeduceMemberType<decltype(mf),
+                                                                 mf>;
+
+  public:
+    /**
+     * Entry I calls member function mfs[I] on 'obj'. All member functions
+     * must be of the same class.
+     */
+    template <auto... mfs>
+    static constexpr interface_delegate
+    make(object_of<mfs...>& obj) noexcept
+    {
+        static_assert(sizeof...(mfs) == sizeof...(Sigs),
+                      "one member function per signature");
+        static_assert(
+            (std::is_same<typename Deduce<Sigs, mfs>::ObjType,
+                          object_of<mfs...>>::value &&
+             ...),
+            "member functions must be of the same class");
+        return interface_delegate{
+            &TableOf<Deduce<Sigs, mfs>::trampoline...>::value,
+            static_cast<void*>(&obj)};
+    }
+
+    // Only when all member functions are const.
+    template <auto... mfs>
+    static constexpr auto make(object_of<mfs...> const& obj) noexcept
+        -> std::enable_if_t<(Deduce<Sigs, mfs>::cnst && ...),
+                            interface_delegate>
+    {
+        static_assert(
+            (std::is_same<typename Deduce<Sigs, mfs>::ObjType,
+                          object_of<mfs...>>::value &&
+             ...),
+            "member functions must be of the same class");
+        return interface_delegate{
+            &TableOf<Deduce<Sigs, mfs>::trampoline...>::value,
+            const_cast<void*>(static_cast<void const*>(&obj))};
+    }
+
+    template <auto... mfs>
+    static interface_delegate make(object_of<mfs...>&&) = delete;
+
+    // Call entry I. Valid to call in null state.
+    template <details::size_t I, typename... A>
+    DELEGATE_ALWAYS_INLINE decltype(auto) call(A&&... args) const
+    {
+        return get<I>()(static_cast<A&&>(args)...);
+    }
+
+    // A delegate calling entry I.
+    template <details::size_t I>
+    constexpr delegate_type<I> get() const noexcept
+    {
+        return delegate_type<I>{details::packGet<I>(*m_table), m_obj};
+    }
+
+    // The object the entries are called on.
+    constexpr void* object() const noexcept
+    {
+        return m_obj;
+    }
+
+    constexpr bool null() const noexcept
+    {
+        return m_table == &NullTable::value;
+    }
+    constexpr explicit operator bool() const noexcept
+    {
+        return !null();
+    }
+
+    constexpr void clear() noexcept
+    {
+        *this = interface_delegate{};
+    }
+
+    static constexpr bool equal(interface_delegate const& lhs,
+                                interface_delegate const& rhs) noexcept
+    {
+        return lhs.m_table == rhs.m_table && lhs.m_obj == rhs.m_obj;
+    }
+
+  private:
+    // One table per set of trampolines.
+    template <auto... fkns>
+    struct TableOf
+    {
+        static constexpr Table value = details::makePack(fkns...);
+    };
+    using NullTable = TableOf<&details::common<Sigs>::doNullCB...>;
+
+    constexpr interface_delegate(Table const* table, void* obj) noexcept
+        : m_obj(obj), m_table(table)
+    {
+    }
+
+    void* m_obj;
+    Table const* m_table;
+};
+
+template <typename... S>
+constexpr bool
+operator==(interface_delegate<S...> const& lhs,
+           interface_delegate<S...> const& rhs) noexcept
+{
+    return interface_delegate<S...>::equal(lhs, rhs);
+}
+
+template <typename... S>
+constexpr bool
+operator!=(interface_delegate<S...> const& lhs,
+           interface_delegate<S...> const& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+template <typename... S>
+constexpr bool
+operator==(interface_delegate<S...> const& lhs, details::nullptr_t) noexcept
+{
+    return lhs.null();
+}
+
+template <typename... S>
+constexpr bool
+operator!=(interface_delegate<S...> const& lhs, details::nullptr_t) noexcept
+{
+    return !lhs.null();
+}
+
+template <typename... S>
+constexpr bool
+operator==(details::nullptr_t, interface_delegate<S...> const& rhs) noexcept
+{
+    return rhs.null();
+}
+
+template <typename... S>
+constexpr bool
+operator!=(details::nullptr_t, interface_delegate<S...> const& rhs) noexcept
+{
+    return !rhs.null();
+}
+
+#endif /* DELEGATE_INTERFACE_DELEGATE_HPP_ */
@@ -0,0 +1,214 @@
+/*
+ * introspection.hpp
+ *
+ * Symbol names of delegate targets, and perf map output for profilers.
+ */
+
+#ifndef DELEGATE_INTROSPECTION_HPP_
+#define DELEGATE_INTROSPECTION_HPP_
+
+/**
+ * In a profile all delegate calls go through trampolines such as
+ * 'doMemberCB<T, mf>'. The template arguments of the trampoline name the
+ * real target, so the demangled trampoline symbol identifies it:
+ *
+ *   target_type_name(d) ->
+ *     "void details::common<void (int)>::doMemberCB<Conn, &Conn::onData>(...)"
+ *
+ * Together with delegate::target_object this tells what a delegate will
+ * call and on which object.
+ *
+ * The names are looked up with dladdr, so only symbols in the dynamic
+ * symbol table are found. For executables, link with -rdynamic (CMake
+ * property ENABLE_EXPORTS). Trampolines for targets with internal linkage,
+ * e.g. in an anonymous namespace, are never found. Unknown addresses give
+ * the address in hex.
+ *
+ * delegate_perf_map writes the trampolines of delegates given to 'add' to
+ * a perf map file, by default /tmp/perf-<pid>.map. Profilers reading perf
+ * maps ('perf', VTune) then show the given names, e.g. the handler name,
+ * also where the symbol table is stripped. Each trampoline is written once.
+ *
+ * POSIX only.
+ */
+
+#include "delegate.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#ifdef __GLIBC__
+#include <link.h>
+#endif
+#include <unistd.h>
+
+namespace details
+{
+
+// Symbol containing 'addr' and its size. Size is 0 if unknown.
+struct symbol_info
+{
+    std::string name;
+    std::uintptr_t start;
+    details::size_t size;
+};
+
+inline std::string
+hexAddress(std::uintptr_t addr)
+{
+    char buf[2 + 2 * sizeof addr + 1];
+    std::snprintf(buf, sizeof buf, "0x%llx",
+                  static_cast<unsigned long long>(addr));
+    return buf;
+}
+
+inline std::string
+demangle(char const* mangled)
+{
+    int status = 0;
+    char* d = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    if (status != 0 || !d)
+        return mangled;
+    std::string r{d};
+    std::free(d);
+    return r;
+}
+
+inline symbol_info
+findSymbol(std::uintptr_t addr)
+{
+    Dl_info info{};
+    void const* p = reinterpret_cast<void const*>(addr);
+#ifdef __GLIBC__
+    void* sym = nullptr;
+    int const ok = dladdr1(p, &info, &sym, RTLD_DL_SYMENT);
+#else
+    int const ok = dladdr(p, &info);
+#endif
+    if (!ok || !info.dli_sname)
+        return symbol_info{hexAddress(addr), addr, 0};
+
+    details::size_t size = 0;
+#ifdef __GLIBC__
+    if (sym)
+        size = static_cast<ElfW(Sym) const*>(sym)->st_size;
+#endif
+    return symbol_info{demangle(info.dli_sname),
+                       reinterpret_cast<std::uintptr_t>(info.dli_saddr), size};
+}
+
+template <typename Trampoline>
+std::uintptr_t
+fknAddress(Trampoline t) noexcept
+{
+    return reinterpret_cast<std::uintptr_t>(t);
+}
+
+} // namespace details
+
+// Demangled name of the function at 'addr', or 'addr' in hex.
+inline std::string
+trampoline_name(std::uintptr_t addr)
+{
+    return details::findSymbol(addr).name;
+}
+
+// Demangled name of the trampoline stored in 'd'.
+template <typename Signature>
+std::string
+target_type_name(delegate<Signature> const& d)
+{
+    return trampoline_name(details::fknAddress(d.trampoline()));
+}
+
+// Demangled name of the trampoline stored in 'mf'.
+template <typename T, bool cnst, typename Signature>
+std::string
+target_type_name(mem_fkn<T, cnst, Signature> const& mf)
+{
+    return trampoline_name(details::fknAddress(mf.ptr()));
+}
+
+/**
+ * Writer of perf map entries, "<start> <size> <name>" in hex, for
+ * trampolines. Thread safe.
+ */
+class delegate_perf_map
+{
+  public:
+    // Append to the perf map of this process.
+    delegate_perf_map() : delegate_perf_map(default_path()) {}
+
+    explicit delegate_perf_map(std::string const& path)
+        : m_file(std::fopen(path.c_str(), "a"))
+    {
+    }
+    delegate_perf_map(delegate_perf_map const&) = delete;
+    delegate_perf_map& operator=(delegate_perf_map const&) = delete;
+
+    ~delegate_perf_map()
+    {
+        if (m_file)
+            std::fclose(m_file);
+    }
+
+    static std::string default_path()
+    {
+        return "/tmp/perf-" + std::to_string(::getpid()) + ".map";
+    }
+
+    // False if the file could not be opened.
+    bool is_open() const noexcept
+    {
+        return m_file != nullptr;
+    }
+
+    /**
+     * Write an entry for the trampoline of 'd', named 'name' or by default
+     * the demangled trampoline name. Return false if the trampoline was
+     * already written or on error.
+     */
+    template <typename Signature>
+    bool add(delegate<Signature> const& d, std::string const& name = {})
+    {
+        return addAddress(details::fknAddress(d.trampoline()), name);
+    }
+
+    template <typename T, bool cnst, typename Signature>
+    bool add(mem_fkn<T, cnst, Signature> const& mf,
+             std::string const& name = {})
+    {
+        return addAddress(details::fknAddress(mf.ptr()), name);
+    }
+
+  private:
+    bool addAddress(std::uintptr_t addr, std::string const& name)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (!m_file || !m_written.insert(addr).second)
+            return false;
+
+        details::symbol_info const sym = details::findSymbol(addr);
+        // Size is only known for symbols found by dladdr. Otherwise cover
+        // the entry of the function.
+        details::size_t const size = sym.size ? sym.size : 1;
+        std::string const& label = name.empty() ? sym.name : name;
+        return std::fprintf(m_file, "%llx %llx %s\n",
+                            static_cast<unsigned long long>(sym.start),
+                            static_cast<unsigned long long>(size),
+                            label.c_str()) > 0 &&
+               std::fflush(m_file) == 0;
+    }
+
+    std::mutex m_mutex;
+    std::FILE* m_file;
+    std::unordered_set<std::uintptr_t> m_written;
+};
+
+#endif /* DELEGATE_INTROSPECTION_HPP_ */
@@ -0,0 +1,153 @@
+/*
+ * multicast_delegate.hpp
+ *
+ * Fixed capacity list of delegates called together.
+ */
+
+#ifndef DELEGATE_MULTICAST_DELEGATE_HPP_
+#define DELEGATE_MULTICAST_DELEGATE_HPP_
+
+/**
+ * Storage of up to N delegates with the same signature, all called when the
+ * multicast_delegate is called. Similar to a 'signal' in signal/slot
+ * libraries.
+ *
+ * Keeps the guarantees of the delegate:
+ * - Never heap allocate. The delegates are stored inline.
+ * - Never throw. A full multicast_delegate refuses new delegates by
+ *   returning false from 'add'.
+ * - Is trivially copyable when the delegates are.
+ *
+ * The stored delegates are kept packed at the start of the storage. There
+ * are never any null delegates among them, so a call only iterate over
+ * actual targets and never passes through the null trampoline.
+ * Remove moves the last delegate into the freed slot. Hence the call order
+ * is the add order only as long as no delegate is removed.
+ *
+ * It is not allowed to add/remove delegates while a call is in progress.
+ *
+ * Like delegate, this header do not include anything besides delegate.hpp,
+ * so it can be included into a custom namespace together with delegate.hpp.
+ */
+
+#include "delegate.hpp"
+
+template <typename Signature, details::size_t N>
+class multicast_delegate;
+
+/**
+ * @param Args Argument list to the function when calling the delegates.
+ * @param N Maximum number of delegates stored.
+ */
+template <typename... Args, details::size_t N>
+class multicast_delegate<void(Args...), N>
+{
+  public:
+    using Delegate = delegate<void(Args...)>;
+    using size_type = details::size_t;
+    using const_iterator = Delegate const*;
+
+    constexpr multicast_delegate() = default;
+
+    // Call all stored delegates, in storage order.
+    void operator()(Args... args) const
+    {
+        for (size_type i = 0; i < m_size; ++i)
+            m_slots[i](args...);
+    }
+
+    /**
+     * Add a delegate last. O(1).
+     * Return false, without storing anything, when full or if 'del' is null.
+     */
+    DELEGATE_CXX14CONSTEXPR bool add(Delegate const& del) noexcept
+    {
+        if (m_size == N || del.null())
+            return false;
+        m_slots[m_size++] = del;
+        return true;
+    }
+
+    /**
+     * Remove the first delegate comparing equal to 'del'. The last delegate
+     * is moved into its place. Return false if 'del' was not found.
+     */
+    DELEGATE_CXX14CONSTEXPR bool remove(Delegate const& del) noexcept
+    {
+        for (size_type i = 0; i < m_size; ++i)
+        {
+            if (Delegate::equal(m_slots[i], del))
+                return remove_at(i);
+        }
+        return false;
+    }
+
+    /**
+     * Remove the delegate at position 'ix'. The last delegate is moved into
+     * its place. O(1). Return false if ix >= size().
+     */
+    DELEGATE_CXX14CONSTEXPR bool remove_at(size_type ix) noexcept
+    {
+        if (ix >= m_size)
+            return false;
+        m_slots[ix] = m_slots[--m_size];
+        m_slots[m_size].clear();
+        return true;
+    }
+
+    constexpr bool contains(Delegate const& del) const noexcept
+    {
+        return find(del, 0) != m_size;
+    }
+
+    DELEGATE_CXX14CONSTEXPR void clear() noexcept
+    {
+        for (size_type i = 0; i < m_size; ++i)
+            m_slots[i].clear();
+        m_size = 0;
+    }
+
+    constexpr size_type size() const noexcept
+    {
+        return m_size;
+    }
+    static constexpr size_type capacity() noexcept
+    {
+        return N;
+    }
+    constexpr bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+    constexpr bool full() const noexcept
+    {
+        return m_size == N;
+    }
+
+    constexpr Delegate const& operator[](size_type ix) const noexcept
+    {
+        return m_slots[ix];
+    }
+    constexpr const_iterator begin() const noexcept
+    {
+        return m_slots;
+    }
+    constexpr const_iterator end() const noexcept
+    {
+        return m_slots + m_size;
+    }
+
+  private:
+    // Recursive to be constexpr for C++11.
+    constexpr size_type find(Delegate const& del, size_type ix) const noexcept
+    {
+        return ix == m_size || Delegate::equal(m_slots[ix], del)
+                   ? ix
+                   : find(del, ix + 1);
+    }
+
+    Delegate m_slots[N] = {};
+    size_type m_size = 0;
+};
+
+#endif /* DELEGATE_MULTICAST_DELEGATE_HPP_ */
@@ -0,0 +1,313 @@
+/*
+ * relocatable_delegate.hpp
+ *
+ * Delegate to objects in a pool, stored as an offset from the pool base.
+ */
+
+#ifndef DELEGATE_RELOCATABLE_DELEGATE_HPP_
+#define DELEGATE_RELOCATABLE_DELEGATE_HPP_
+
+/**
+ * A delegate stores the address of its object, so objects bound to
+ * delegates can not be moved. For objects in an arena or slab the
+ * relocatable_delegate instead stores a handle: a pool id and the byte
+ * offset of the object from the pool base. The pool bases are kept in a
+ * global table, delegate_pools. The trampoline resolves the object at call
+ * time with one load, the base of the pool.
+ *
+ *   delegate_pool_id pool = delegate_pools::add(slab);
+ *   auto d = relocatable_delegate<void(int)>::make<Conn, &Conn::onData>(
+ *       pool, slab[3]);
+ *   ...
+ *   // Move all objects of the slab, e.g. when growing it.
+ *   delegate_pools::rebase(pool, newSlab);
+ *   d(42); // Calls newSlab[3].onData(42).
+ *
+ * Moving the arena as a whole only needs a 'rebase'. Objects moved within
+ * the arena change offset, delegates to them must be made again.
+ *
+ * The handle is stored in the data word of a plain delegate, so a
+ * relocatable_delegate is 2 words and trivially copyable, and converts
+ * implicitly to a delegate calling the same target. No heap allocation,
+ * no exceptions.
+ *
+ * The handle has DELEGATE_POOL_BITS (default 8) bits pool id, the rest is
+ * the offset. The byte offset must fit, e.g. 56 bits on 64-bit targets and
+ * 24 bits (16 MiB) on 32-bit targets. 'make' returns a null delegate if the
+ * pool is not registered, the object is below the pool base, the offset
+ * does not fit or is not a multiple of the object's alignment.
+ *
+ * Changing a pool base while another thread call delegates to the pool is
+ * not synchronized, the caller may see either base.
+ */
+
+#include "delegate.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef DELEGATE_POOL_BITS
+#define DELEGATE_POOL_BITS 8
+#endif
+
+using delegate_pool_id = unsigned;
+
+// Returned by delegate_pools::add when all pool ids are in use.
+constexpr delegate_pool_id invalid_delegate_pool = 0;
+
+namespace details
+{
+
+// Zero initialized at compile time, no guard on access.
+template <typename = void>
+struct pool_table
+{
+    static constexpr unsigned bits = DELEGATE_POOL_BITS;
+    static constexpr unsigned size = 1u << bits;
+    static std::atomic<char*> s_bases[size];
+};
+template <typename D>
+std::atomic<char*> pool_table<D>::s_bases[pool_table<D>::size];
+
+} // namespace details
+
+// Table of pool base addresses. Id 0 is never used.
+class delegate_pools
+{
+    using Table = details::pool_table<>;
+
+  public:
+    static constexpr unsigned max_pools = Table::size - 1;
+
+    static constexpr unsigned offset_bits =
+        sizeof(std::uintptr_t) * 8 - Table::bits;
+    static constexpr std::uintptr_t offset_mask =
+        (std::uintptr_t{1} << offset_bits) - 1;
+
+    // Register a pool starting at 'base'. Return invalid_delegate_pool if
+    // all ids are in use.
+    static delegate_pool_id add(void* base) noexcept
+    {
+        for (delegate_pool_id id = 1; id < Table::size; ++id)
+        {
+            char* expected = nullptr;
+            if (Table::s_bases[id].compare_exchange_strong(
+                    expected, static_cast<char*>(base)))
+                return id;
+        }
+        return invalid_delegate_pool;
+    }
+
+    // The pool has moved to 'base'. Existing delegates follow.
+    static void rebase(delegate_pool_id id, void* base) noexcept
+    {
+        Table::s_bases[id].store(static_cast<char*>(base),
+                                 std::memory_order_release);
+    }
+
+    // Make the id available for a new pool.
+    static void remove(delegate_pool_id id) noexcept
+    {
+        Table::s_bases[id].store(nullptr, std::memory_order_release);
+    }
+
+    static void* base(delegate_pool_id id) noexcept
+    {
+        return Table::s_bases[id].load(std::memory_order_acquire);
+    }
+
+    /**
+     * Handle for 'obj' in pool 'id'. Return 0 if 'id' is not a registered
+     * pool, 'obj' is below its base, or the offset is larger than
+     * offset_mask or not a multiple of 'align'.
+     */
+    static std::uintptr_t handle(delegate_pool_id id, void const* obj,
+                                 std::uintptr_t align = 1) noexcept
+    {
+        if (id == invalid_delegate_pool || id > max_pools)
+            return 0;
+        auto const b = reinterpret_cast<std::uintptr_t>(base(id));
+        auto const addr = reinterpret_cast<std::uintptr_t>(obj);
+        if (b == 0 || addr < b)
+            return 0;
+        std::uintptr_t const offset = addr - b;
+        if (offset > offset_mask || offset % align != 0)
+            return 0;
+        return (std::uintptr_t{id} << offset_bits) | offset;
+    }
+
+    static delegate_pool_id pool_of(std::uintptr_t handle) noexcept
+    {
+        return static_cast<delegate_pool_id>(handle >> offset_bits);
+    }
+    static std::uintptr_t offset_of(std::uintptr_t handle) noexcept
+    {
+        return handle & offset_mask;
+    }
+
+    // Current address of the object for 'handle'.
+    static void* resolve(std::uintptr_t handle) noexcept
+    {
+        // Relaxed: compiles to a plain load.
+        return Table::s_bases[handle >> offset_bits].load(
+                   std::memory_order_relaxed) +
+               (handle & offset_mask);
+    }
+};
+
+template <typename Signature>
+class relocatable_delegate;
+
+/**
+ * @param R type of the return value from calling the callback.
+ * @param Args Argument list to the function when calling the callback.
+ */
+template <typename R, typename... Args>
+class relocatable_delegate<R(Args...)>
+{
+  public:
+    using Delegate = delegate<R(Args...)>;
+    using DataPtr = typename Delegate::DataPtr;
+    using Trampoline = typename Delegate::Trampoline;
+
+    // Default construct to null state.
+    constexpr relocatable_delegate() = default;
+    constexpr relocatable_delegate(details::nullptr_t) noexcept {}
+
+    /**
+     * Call member function 'mf' on 'obj', which must be in pool 'pool'.
+     * Return a null delegate if 'obj' has no handle in the pool.
+     */
+    template <class T, R (T::*mf)(Args...)>
+    static relocatable_delegate make(delegate_pool_id pool, T& obj) noexcept
+    {
+        return fromHandle(&doMember<T, mf>,
+                          delegate_pools::handle(pool, &obj, alignof(T)));
+    }
+
+    template <class T, R (T::*mf)(Args...) const>
+    static relocatable_delegate make(delegate_pool_id pool,
+                                     T const& obj) noexcept
+    {
+        return fromHandle(&doConstMember<T, mf>,
+                          delegate_pools::handle(pool, &obj, alignof(T)));
+    }
+
+    // Delete r-values. Not interested in temporaries.
+    template <class T, R (T::*mf)(Args...)>
+    static relocatable_delegate make(delegate_pool_id, T&&) = delete;
+    template <class T, R (T::*mf)(Args...) const>
+    static relocatable_delegate make(delegate_pool_id, T&&) = delete;
+
+    // Call the target. Valid to call in null state.
+    DELEGATE_ALWAYS_INLINE R operator()(Args... args) const
+    {
+        return m_del(details::fwd<Args>(args)...);
+    }
+
+    // A delegate calling the same target, also after a rebase.
+    constexpr operator Delegate() const noexcept
+    {
+        return m_del;
+    }
+
+    constexpr bool null() const noexcept
+    {
+        return m_del.null();
+    }
+    constexpr explicit operator bool() const noexcept
+    {
+        return !null();
+    }
+
+    DELEGATE_CXX14CONSTEXPR void clear() noexcept
+    {
+        m_del.clear();
+    }
+
+    // The pool and byte offset of the target object.
+    delegate_pool_id pool() const noexcept
+    {
+        return delegate_pools::pool_of(handle());
+    }
+    std::uintptr_t offset() const noexcept
+    {
+        return delegate_pools::offset_of(handle());
+    }
+
+    static bool equal(relocatable_delegate const& lhs,
+                      relocatable_delegate const& rhs) noexcept
+    {
+        return Delegate::equal(lhs.m_del, rhs.m_del);
+    }
+
+  private:
+    relocatable_delegate(Trampoline fkn, std::uintptr_t handle) noexcept
+        : m_del(fkn, reinterpret_cast<void*>(handle))
+    {
+    }
+
+    static relocatable_delegate fromHandle(Trampoline fkn,
+                                           std::uintptr_t handle) noexcept
+    {
+        return handle ? relocatable_delegate{fkn, handle}
+                      : relocatable_delegate{};
+    }
+
+    std::uintptr_t handle() const noexcept
+    {
+        return reinterpret_cast<std::uintptr_t>(m_del.data().ptr());
+    }
+
+    template <class T, R (T::*mf)(Args...)>
+    static R doMember(DataPtr d,
+                      typename Delegate::template Param<Args>... args)
+    {
+        auto obj = static_cast<T*>(delegate_pools::resolve(
+            reinterpret_cast<std::uintptr_t>(d.ptr())));
+        return (obj->*mf)(details::fwd<Args>(args)...);
+    }
+
+    template <class T, R (T::*mf)(Args...) const>
+    static R doConstMember(DataPtr d,
+                           typename Delegate::template Param<Args>... args)
+    {
+        auto obj = static_cast<T const*>(delegate_pools::resolve(
+            reinterpret_cast<std::uintptr_t>(d.ptr())));
+        return (obj->*mf)(details::fwd<Args>(args)...);
+    }
+
+    Delegate m_del;
+};
+
+template <typename S>
+bool
+operator==(relocatable_delegate<S> const& lhs,
+           relocatable_delegate<S> const& rhs) noexcept
+{
+    return relocatable_delegate<S>::equal(lhs, rhs);
+}
+
+template <typename S>
+bool
+operator!=(relocatable_delegate<S> const& lhs,
+           relocatable_delegate<S> const& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+template <typename S>
+constexpr bool
+operator==(relocatable_delegate<S> const& lhs, details::nullptr_t) noexcept
+{
+    return lhs.null();
+}
+
+template <typename S>
+constexpr bool
+operator!=(relocatable_delegate<S> const& lhs, details::nullptr_t) noexcept
+{
+    return !lhs.null();
+}
+
+#endif /* DELEGATE_RELOCATABLE_DELEGATE_HPP_ */
@@ -0,0 +1,141 @@
+#include "delegate/arena_delegate.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Big
+{
+    int values[16];
+};
+
+// Count live instances, to check destructor tracking.
+struct Tracked
+{
+    explicit Tracked(int* live) noexcept : m_live(live)
+    {
+        ++*m_live;
+    }
+    Tracked(Tracked const& o) noexcept : m_live(o.m_live)
+    {
+        ++*m_live;
+    }
+    ~Tracked()
+    {
+        --*m_live;
+    }
+    int operator()(int x) const
+    {
+        return x + *m_live;
+    }
+    int* m_live;
+};
+
+} // namespace
+
+TEST(arena_delegate, store_and_call)
+{
+    alignas(std::max_align_t) unsigned char buf[256];
+    delegate_arena arena(buf);
+    EXPECT_EQ(arena.capacity(), 256u);
+    EXPECT_EQ(arena.used(), 0u);
+
+    Big big{};
+    for (int i = 0; i < 16; ++i)
+        big.values[i] = i;
+    auto d = arena_delegate<int(int)>(arena, [big](int ix) {
+        return big.values[ix];
+    });
+    ASSERT_TRUE(d);
+    EXPECT_GE(arena.used(), sizeof(Big));
+    EXPECT_EQ(d(7), 7);
+
+    // The copy lives in the arena, not in 'big'.
+    big.values[7] = 100;
+    EXPECT_EQ(d(7), 7);
+    auto obj = static_cast<unsigned char*>(d.target_object());
+    EXPECT_TRUE(obj >= buf && obj < buf + sizeof buf);
+}
+
+TEST(arena_delegate, exhausted_gives_null)
+{
+    alignas(std::max_align_t) unsigned char buf[100];
+    delegate_arena arena(buf, sizeof buf);
+    Big big{};
+    auto d1 = arena_delegate<int(int)>(arena, [big](int ix) {
+        return big.values[ix];
+    });
+    EXPECT_TRUE(d1);
+    auto const used = arena.used();
+    auto d2 = arena_delegate<int(int)>(arena, [big](int ix) {
+        return big.values[ix];
+    });
+    EXPECT_FALSE(d2);
+    EXPECT_EQ(arena.used(), used);
+
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.remaining(), 100u);
+    auto d3 = arena_delegate<int(int)>(arena, [big](int ix) {
+        return big.values[ix];
+    });
+    EXPECT_TRUE(d3);
+}
+
+TEST(arena_delegate, alignment)
+{
+    struct alignas(16) Aligned
+    {
+        int v;
+        int operator()() const
+        {
+            return v;
+        }
+    };
+    alignas(std::max_align_t) unsigned char buf[128];
+    delegate_arena arena(buf);
+    arena.store(char{1});
+    Aligned* p = arena.store(Aligned{5});
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % 16, 0u);
+    EXPECT_EQ(delegate<int()>::make(*p)(), 5);
+}
+
+TEST(arena_delegate, destructor_tracking)
+{
+    int live = 0;
+    alignas(std::max_align_t) unsigned char buf[256];
+    {
+        delegate_arena arena(buf);
+        Tracked t(&live);
+        auto d1 = arena_delegate<int(int)>(arena, t);
+        auto d2 = arena_delegate<int(int)>(arena, t);
+        EXPECT_EQ(live, 3);
+        EXPECT_EQ(d1(1), 4);
+        EXPECT_EQ(d2(1), 4);
+
+        arena.reset();
+        EXPECT_EQ(live, 1);
+
+        arena_delegate<int(int)>(arena, t);
+        EXPECT_EQ(live, 2);
+    }
+    // Arena destructor and 't' went out of scope.
+    EXPECT_EQ(live, 0);
+}
+
+TEST(arena_delegate, exhausted_tracked_not_constructed)
+{
+    int live = 0;
+    unsigned char buf[sizeof(Tracked) + 2];
+    delegate_arena arena(buf);
+    Tracked t(&live);
+    auto d = arena_delegate<int(int)>(arena, t);
+    EXPECT_FALSE(d);
+    EXPECT_EQ(live, 1);
+    EXPECT_EQ(arena.used(), 0u);
+}
@@ -0,0 +1,150 @@
+#include "delegate/atomic_delegate.hpp"
+
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Obj
+{
+    int get1() const
+    {
+        return m_id * 10 + 1;
+    }
+    int get2() const
+    {
+        return m_id * 10 + 2;
+    }
+    int m_id;
+};
+
+int
+freeFkn()
+{
+    return 7;
+}
+
+using Del = delegate<int()>;
+
+template <typename Storage>
+class atomic_delegate_test : public ::testing::Test
+{
+};
+
+#ifdef DELEGATE_HAVE_DWCAS
+using Storages = ::testing::Types<details::versioned_atomic_storage,
+                                  details::dwcas_atomic_storage>;
+#else
+using Storages = ::testing::Types<details::versioned_atomic_storage>;
+#endif
+
+// Loads of the default storage never write to the shared cache line.
+#ifdef DELEGATE_HAVE_DWLOAD
+static_assert(std::is_same<details::default_atomic_storage,
+                           details::dwcas_atomic_storage>::value,
+              "plain 16 byte load, use dwcas storage");
+#else
+static_assert(std::is_same<details::default_atomic_storage,
+                           details::versioned_atomic_storage>::value,
+              "no plain double width load, use versioned storage");
+#endif
+
+// The versioned load retries while stores complete, it is only lock-free.
+static_assert(!atomic_delegate<void(int), details::versioned_atomic_storage>::
+                  is_load_wait_free,
+              "versioned load is not wait-free");
+
+} // namespace
+
+TYPED_TEST_SUITE(atomic_delegate_test, Storages);
+
+TYPED_TEST(atomic_delegate_test, load_store)
+{
+    using ADel = atomic_delegate<int(), TypeParam>;
+    Obj o{1};
+    ADel ad;
+    EXPECT_TRUE(ad.load() == nullptr);
+    EXPECT_EQ(ad(), 0);
+
+    ad.store(Del::make<Obj, &Obj::get1>(o));
+    EXPECT_TRUE(ad.load() == (Del::make<Obj, &Obj::get1>(o)));
+    EXPECT_EQ(ad(), 11);
+
+    ad = Del::make<freeFkn>();
+    EXPECT_EQ(ad(), 7);
+
+    // Runtime function pointer use the other union member.
+    ad = Del::make(freeFkn);
+    Del d = ad;
+    EXPECT_TRUE(d == Del::make(freeFkn));
+    EXPECT_EQ(d(), 7);
+
+    ADel ad2{Del::make<Obj, &Obj::get2>(o)};
+    EXPECT_EQ(ad2(), 12);
+}
+
+TYPED_TEST(atomic_delegate_test, exchange)
+{
+    using ADel = atomic_delegate<int(), TypeParam>;
+    Obj o{2};
+    ADel ad{Del::make<Obj, &Obj::get1>(o)};
+    Del old = ad.exchange(Del::make<Obj, &Obj::get2>(o));
+    EXPECT_EQ(old(), 21);
+    EXPECT_EQ(ad(), 22);
+}
+
+TYPED_TEST(atomic_delegate_test, compare_exchange)
+{
+    using ADel = atomic_delegate<int(), TypeParam>;
+    Obj o{3};
+    auto d1 = Del::make<Obj, &Obj::get1>(o);
+    auto d2 = Del::make<Obj, &Obj::get2>(o);
+
+    ADel ad{d1};
+    Del expected = d2;
+    EXPECT_FALSE(ad.compare_exchange(expected, Del{}));
+    EXPECT_TRUE(expected == d1);
+    EXPECT_EQ(ad(), 31);
+
+    EXPECT_TRUE(ad.compare_exchange(expected, d2));
+    EXPECT_EQ(ad(), 32);
+}
+
+// Readers must never see the trampoline of one delegate combined with the
+// data pointer of the other.
+TYPED_TEST(atomic_delegate_test, no_torn_reads)
+{
+    using ADel = atomic_delegate<int(), TypeParam>;
+    Obj a{1};
+    Obj b{2};
+    auto d1 = Del::make<Obj, &Obj::get1>(a); // 11
+    auto d2 = Del::make<Obj, &Obj::get2>(b); // 22
+
+    ADel ad{d1};
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i)
+    {
+        readers.emplace_back([&] {
+            while (!done.load())
+            {
+                int r = ad();
+                if (r != 11 && r != 22)
+                    bad++;
+            }
+        });
+    }
+    for (int i = 0; i < 200000; ++i)
+        ad.store(i & 1 ? d1 : d2);
+    done = true;
+    for (auto& t : readers)
+        t.join();
+    EXPECT_EQ(bad.load(), 0);
+}
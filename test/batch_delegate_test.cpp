@@ -0,0 +1,173 @@
+#include "delegate/batch_delegate.hpp"
+
+#include <array>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Sample
+{
+    int value;
+};
+
+struct Sum
+{
+    void add(Sample const& s)
+    {
+        m_sum += s.value;
+        ++m_count;
+    }
+    void check(Sample const& s) const
+    {
+        m_last = s.value;
+    }
+    int m_sum = 0;
+    int m_count = 0;
+    mutable int m_last = -1;
+};
+
+int s_freeSum = 0;
+
+void
+freeAdd(Sample const& s)
+{
+    s_freeSum += s.value;
+}
+
+void
+doubleIt(int& x)
+{
+    x *= 2;
+}
+
+using BatchDel = batch_delegate<void(Sample const&)>;
+
+} // namespace
+
+TEST(batch_delegate, null_state)
+{
+    BatchDel d;
+    EXPECT_TRUE(d.null());
+    EXPECT_FALSE(d);
+    EXPECT_TRUE(d == nullptr);
+    EXPECT_TRUE(nullptr == d);
+    Sample buf[] = {{1}, {2}};
+    d(buf, 2);
+    d(buf);
+
+    BatchDel d2{nullptr};
+    EXPECT_TRUE(d2.null());
+    EXPECT_TRUE(d == d2);
+}
+
+TEST(batch_delegate, size_and_copy)
+{
+    EXPECT_EQ(sizeof(BatchDel), 2 * sizeof(void*));
+    EXPECT_TRUE(std::is_trivially_copyable<BatchDel>::value);
+    EXPECT_TRUE((std::is_same<BatchDel::Pointer, Sample const*>::value));
+    EXPECT_TRUE((std::is_same<batch_delegate<void(int&)>::Pointer,
+                              int*>::value));
+    EXPECT_TRUE(
+        (std::is_same<batch_delegate<void(int)>::Pointer, int const*>::value));
+}
+
+TEST(batch_delegate, member_function)
+{
+    Sum sum;
+    auto d = BatchDel::make<Sum, &Sum::add>(sum);
+    EXPECT_TRUE(d != nullptr);
+    Sample buf[] = {{1}, {2}, {3}, {4}};
+    d(buf, 3);
+    EXPECT_EQ(sum.m_sum, 6);
+    EXPECT_EQ(sum.m_count, 3);
+    d(buf, 0);
+    EXPECT_EQ(sum.m_count, 3);
+
+    Sum const& csum = sum;
+    auto cd = BatchDel::make<Sum, &Sum::check>(csum);
+    cd(buf, 4);
+    EXPECT_EQ(sum.m_last, 4);
+}
+
+TEST(batch_delegate, free_function)
+{
+    s_freeSum = 0;
+    auto d = BatchDel::make<freeAdd>();
+    std::vector<Sample> buf{{5}, {6}};
+    d(buf);
+    EXPECT_EQ(s_freeSum, 11);
+}
+
+TEST(batch_delegate, functor)
+{
+    int sum = 0;
+    auto lambda = [&sum](int x) { sum += x; };
+    auto d = batch_delegate<void(int)>::make(lambda);
+    std::array<int, 3> buf = {{1, 2, 3}};
+    d(buf);
+    EXPECT_EQ(sum, 6);
+
+    int const values[] = {10, 20};
+    d(values);
+    EXPECT_EQ(sum, 36);
+}
+
+TEST(batch_delegate, from_element_delegate)
+{
+    Sum sum;
+    auto elem = delegate<void(Sample const&)>::make<Sum, &Sum::add>(sum);
+    auto d = BatchDel::make(elem);
+    Sample buf[] = {{1}, {2}};
+    d(buf);
+    EXPECT_EQ(sum.m_sum, 3);
+}
+
+TEST(batch_delegate, modify_elements)
+{
+    auto d = batch_delegate<void(int&)>::make<doubleIt>();
+    std::vector<int> buf{1, 2, 3};
+    d(buf);
+    EXPECT_EQ(buf, (std::vector<int>{2, 4, 6}));
+    d(buf.data() + 1, 1);
+    EXPECT_EQ(buf, (std::vector<int>{2, 8, 6}));
+}
+
+TEST(batch_delegate, batch_and_equality)
+{
+    Sum s1;
+    Sum s2;
+    auto d1 = BatchDel::make<Sum, &Sum::add>(s1);
+    auto d1b = BatchDel::make<Sum, &Sum::add>(s1);
+    auto d2 = BatchDel::make<Sum, &Sum::add>(s2);
+    EXPECT_TRUE(d1 == d1b);
+    EXPECT_TRUE(d1 != d2);
+
+    BatchDel::Delegate b = d1.batch();
+    Sample buf[] = {{7}};
+    b(buf, 1);
+    EXPECT_EQ(s1.m_sum, 7);
+
+    d1.clear();
+    EXPECT_TRUE(d1.null());
+}
+
+#if __cplusplus >= 201703
+TEST(batch_delegate, deduced_member_function)
+{
+    Sum sum;
+    auto d = BatchDel::make<&Sum::add>(sum);
+    Sample buf[] = {{2}, {3}};
+    d(buf);
+    EXPECT_EQ(sum.m_sum, 5);
+    EXPECT_TRUE((d == BatchDel::make<Sum, &Sum::add>(sum)));
+
+    Sum const& csum = sum;
+    auto cd = BatchDel::make<&Sum::check>(csum);
+    cd(buf);
+    EXPECT_EQ(sum.m_last, 3);
+}
+#endif
@@ -0,0 +1,141 @@
+#include "delegate/bound_delegate.hpp"
+
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Server
+{
+    int onData(int conn, int value)
+    {
+        m_conn = conn;
+        return conn * 100 + value;
+    }
+    int scaled(int conn, short scale, int value) const
+    {
+        return (conn + m_offset) * scale + value;
+    }
+    void reset(int conn) noexcept
+    {
+        m_conn = conn;
+    }
+    int sum(int a, int b) const noexcept
+    {
+        return a + b + m_offset;
+    }
+    int m_conn = -1;
+    int m_offset = 1;
+};
+
+int
+freeFkn(int a, int b, int c)
+{
+    return a * 100 + b * 10 + c;
+}
+
+} // namespace
+
+TEST(bound_delegate, null_state)
+{
+    bound_delegate<int(int), int> del;
+    EXPECT_TRUE(del.null());
+    EXPECT_FALSE(del);
+    EXPECT_TRUE(del == nullptr);
+    EXPECT_TRUE(nullptr == del);
+    EXPECT_EQ(del(1), 0);
+    EXPECT_TRUE(del.view().null());
+
+    bound_delegate<int(int), int> del2{nullptr};
+    EXPECT_TRUE(del2.null());
+}
+
+TEST(bound_delegate, member_function)
+{
+    Server s;
+    auto del = bound_delegate<int(int), int>::make<Server, &Server::onData>(
+        s, 3);
+    EXPECT_TRUE(del != nullptr);
+    EXPECT_EQ(del(7), 307);
+    EXPECT_EQ(s.m_conn, 3);
+
+    Server const& cs = s;
+    auto cdel = bound_delegate<int(int), int, short>::make<
+        Server, &Server::scaled>(cs, 2, short{10});
+    EXPECT_EQ(cdel(5), 35);
+}
+
+TEST(bound_delegate, free_function)
+{
+    auto del = bound_delegate<int(int), int, int>::make<freeFkn>(1, 2);
+    EXPECT_EQ(del(3), 123);
+
+    auto del2 = bound_delegate<int(int, int, int)>::make<freeFkn>();
+    EXPECT_EQ(del2(4, 5, 6), 456);
+
+    del.clear();
+    EXPECT_TRUE(del.null());
+    EXPECT_EQ(del(3), 0);
+}
+
+TEST(bound_delegate, is_inline_and_trivially_copyable)
+{
+    using BD = bound_delegate<int(int), int, short>;
+    EXPECT_TRUE(std::is_trivially_copyable<BD>::value);
+    EXPECT_LE(sizeof(BD), 3 * sizeof(void*) + sizeof(int) + sizeof(short));
+
+    Server s;
+    auto del = bound_delegate<int(int), int>::make<Server, &Server::onData>(
+        s, 4);
+    auto copy = del;
+    EXPECT_EQ(copy(1), 401);
+}
+
+TEST(bound_delegate, view)
+{
+    Server s;
+    auto del = bound_delegate<int(int), int>::make<Server, &Server::onData>(
+        s, 5);
+    delegate<int(int)> view = del.view();
+    EXPECT_EQ(view(2), 502);
+}
+
+#if DELEGATE_CPP_VERSION >= 201703L
+
+TEST(bound_delegate, make_bound)
+{
+    Server s;
+    auto del = make_bound<&Server::onData>(s, 6);
+    static_assert(
+        std::is_same<decltype(del), bound_delegate<int(int), int>>::value);
+    EXPECT_EQ(del(1), 601);
+
+    Server const& cs = s;
+    auto cdel = make_bound<&Server::scaled>(cs, 1, short{3});
+    static_assert(std::is_same<decltype(cdel),
+                               bound_delegate<int(int), int, short>>::value);
+    EXPECT_EQ(cdel(1), 7);
+
+    auto all = make_bound<&Server::scaled>(cs);
+    EXPECT_EQ(all(1, short{2}, 3), 7);
+}
+
+TEST(bound_delegate, make_bound_noexcept)
+{
+    Server s;
+    auto del = make_bound<&Server::reset>(s, 4);
+    static_assert(
+        std::is_same<decltype(del), bound_delegate<void(), int>>::value);
+    del();
+    EXPECT_EQ(s.m_conn, 4);
+
+    Server const& cs = s;
+    auto cdel = make_bound<&Server::sum>(cs, 10);
+    static_assert(
+        std::is_same<decltype(cdel), bound_delegate<int(int), int>>::value);
+    EXPECT_EQ(cdel(5), 16);
+}
+
+#endif
@@ -0,0 +1,346 @@
+/*
+ * codegen_dispatch.cpp
+ *
+ * The code generated for each make and set function, compiled with -O2 and
+ * disassembled by cmake/check_codegen.cmake.
+ *
+ * - Trampolines: for targets out of line, each trampoline is a tail call
+ *   to the target. At most a register move for the arguments, no stack use
+ *   and no null check.
+ * - Constants: a delegate made and called in the same function, or a
+ *   constexpr delegate, is seen through by the optimizer. An inline target
+ *   is inlined, an out of line target is called directly.
+ *
+ * Expectations are given as '<slashes> codegen: <symbol regex> <kind> [max]'.
+ */
+
+#include "delegate/delegate.hpp"
+
+namespace codegen
+{
+
+// Targets defined elsewhere.
+struct Ext
+{
+    int add(int x);
+    int cadd(int x) const;
+    int operator()(int x);
+    int operator()(int x) const;
+};
+int extFree(int x);
+int extWithObj(Ext& e, int x);
+int extWithConstObj(Ext const& e, int x);
+int extWithVoid(void* p, int x);
+int extWithConstVoid(void const* p, int x);
+extern Ext g_ext;
+extern Ext const g_cext;
+
+// Targets visible for inlining.
+struct Counter
+{
+    int get(int x)
+    {
+        return m_val + x;
+    }
+    int cget(int x) const
+    {
+        return m_val - x;
+    }
+    int m_val;
+};
+struct Scale
+{
+    int operator()(int x) const
+    {
+        return 3 * x;
+    }
+};
+inline int
+twice(int x)
+{
+    return 2 * x;
+}
+inline int
+withCounter(Counter& c, int x)
+{
+    return c.m_val * x;
+}
+inline int
+withVoid(void* p, int x)
+{
+    return static_cast<Counter*>(p)->m_val ^ x;
+}
+extern Counter g_counter;
+extern Counter const g_ccounter;
+extern Scale const g_scale;
+
+using IntDel = delegate<int(int)>;
+using MemFkn = mem_fkn<Counter, false, int(int)>;
+
+constexpr IntDel k_member = IntDel::make<Counter, &Counter::get>(g_counter);
+
+} // namespace codegen
+
+using namespace codegen;
+
+extern "C"
+{
+
+// Trampolines of out of line targets. The function returning the trampoline
+// instantiates it.
+
+// codegen: .*doMemberCB.*3Ext.*3add.* direct_tail_call 1
+IntDel::Trampoline
+codegen_tramp_member()
+{
+    return IntDel::make<Ext, &Ext::add>(g_ext).trampoline();
+}
+
+// codegen: .*doConstMemberCB.*3Ext.*4cadd.* direct_tail_call 1
+IntDel::Trampoline
+codegen_tramp_const_member()
+{
+    return IntDel::make<Ext, &Ext::cadd>(g_cext).trampoline();
+}
+
+// The data pointer argument is dropped, the rest moved one register.
+// codegen: .*doFreeCB.*7extFree.* direct_tail_call 2
+IntDel::Trampoline
+codegen_tramp_free()
+{
+    return IntDel::make<extFree>().trampoline();
+}
+
+// codegen: .*doFunctorIN7codegen3ExtE.* direct_tail_call 1
+IntDel::Trampoline
+codegen_tramp_functor()
+{
+    return IntDel::make(g_ext).trampoline();
+}
+
+// codegen: .*doConstFunctorIN7codegen3ExtE.* direct_tail_call 1
+IntDel::Trampoline
+codegen_tramp_const_functor()
+{
+    return IntDel::make(g_cext).trampoline();
+}
+
+// codegen: .*dofreeFknWithObjectRef.*10extWithObj.* direct_tail_call 1
+IntDel::Trampoline
+codegen_tramp_with_object()
+{
+    return IntDel::make_free_with_object<Ext, extWithObj>(g_ext).trampoline();
+}
+
+// codegen: .*dofreeFknWithObjectConstRef.*15extWithConstObj.* direct_tail_call 1
+IntDel::Trampoline
+codegen_tramp_with_const_object()
+{
+    return IntDel::make_free_with_object<Ext, extWithConstObj>(g_cext)
+        .trampoline();
+}
+
+// codegen: .*dofreeFknWithVoidPtr.*11extWithVoid.* direct_tail_call 1
+IntDel::Trampoline
+codegen_tramp_with_void()
+{
+    return IntDel::make_free_with_void<extWithVoid>(&g_ext).trampoline();
+}
+
+// codegen: .*dofreeFknWithVoidConstPtr.*16extWithConstVoid.* direct_tail_call 1
+IntDel::Trampoline
+codegen_tramp_with_const_void()
+{
+    return IntDel::make_free_with_void<extWithConstVoid>(&g_cext)
+        .trampoline();
+}
+
+// Function pointer stored in the data pointer.
+// codegen: .*doRuntimeFkn.* indirect_tail_call 3
+IntDel::Trampoline
+codegen_tramp_fkn_ptr(IntDel::FknPtr f)
+{
+    return IntDel{f}.trampoline();
+}
+
+// Constant delegates with inline targets, the target is inlined.
+
+// codegen: codegen_inline_null inlined 2
+int
+codegen_inline_null(int x)
+{
+    return IntDel{}(x);
+}
+
+// codegen: codegen_inline_make_free inlined 2
+int
+codegen_inline_make_free(int x)
+{
+    return IntDel::make<twice>()(x);
+}
+
+// codegen: codegen_inline_make_member inlined 3
+int
+codegen_inline_make_member(int x)
+{
+    return IntDel::make<Counter, &Counter::get>(g_counter)(x);
+}
+
+// codegen: codegen_inline_make_const_member inlined 3
+int
+codegen_inline_make_const_member(int x)
+{
+    return IntDel::make<Counter, &Counter::cget>(g_ccounter)(x);
+}
+
+// codegen: codegen_inline_make_functor inlined 2
+int
+codegen_inline_make_functor(int x)
+{
+    return IntDel::make(g_scale)(x);
+}
+
+// codegen: codegen_inline_make_fkn_ptr inlined 2
+int
+codegen_inline_make_fkn_ptr(int x)
+{
+    return IntDel::make(twice)(x);
+}
+
+// codegen: codegen_inline_fkn_ptr_ctor inlined 2
+int
+codegen_inline_fkn_ptr_ctor(int x)
+{
+    return IntDel{twice}(x);
+}
+
+// codegen: codegen_inline_make_with_object inlined 3
+int
+codegen_inline_make_with_object(int x)
+{
+    return IntDel::make_free_with_object<Counter, withCounter>(g_counter)(x);
+}
+
+// codegen: codegen_inline_make_with_void inlined 3
+int
+codegen_inline_make_with_void(int x)
+{
+    return IntDel::make_free_with_void<withVoid>(&g_counter)(x);
+}
+
+// codegen: codegen_inline_make_mem_fkn inlined 3
+int
+codegen_inline_make_mem_fkn(int x)
+{
+    constexpr MemFkn mf = MemFkn::make<&Counter::get>();
+    return IntDel::make(mf, g_counter)(x);
+}
+
+// codegen: codegen_inline_constexpr inlined 3
+int
+codegen_inline_constexpr(int x)
+{
+    return k_member(x);
+}
+
+// codegen: codegen_inline_set_free inlined 2
+int
+codegen_inline_set_free(int x)
+{
+    IntDel d;
+    d.set<twice>();
+    return d(x);
+}
+
+// codegen: codegen_inline_set_member inlined 3
+int
+codegen_inline_set_member(int x)
+{
+    IntDel d;
+    d.set<Counter, &Counter::get>(g_counter);
+    return d(x);
+}
+
+// codegen: codegen_inline_set_const_member inlined 3
+int
+codegen_inline_set_const_member(int x)
+{
+    IntDel d;
+    d.set<Counter, &Counter::cget>(g_ccounter);
+    return d(x);
+}
+
+// codegen: codegen_inline_set_functor inlined 2
+int
+codegen_inline_set_functor(int x)
+{
+    IntDel d;
+    d.set(g_scale);
+    return d(x);
+}
+
+// codegen: codegen_inline_set_fkn_ptr inlined 2
+int
+codegen_inline_set_fkn_ptr(int x)
+{
+    IntDel d;
+    d.set(twice);
+    return d(x);
+}
+
+// codegen: codegen_inline_set_with_object inlined 3
+int
+codegen_inline_set_with_object(int x)
+{
+    IntDel d;
+    d.set_free_with_object<Counter, withCounter>(g_counter);
+    return d(x);
+}
+
+// codegen: codegen_inline_set_with_void inlined 3
+int
+codegen_inline_set_with_void(int x)
+{
+    IntDel d;
+    d.set_free_with_void<withVoid>(&g_counter);
+    return d(x);
+}
+
+// codegen: codegen_inline_auto_member inlined 3
+int
+codegen_inline_auto_member(int x)
+{
+    return IntDel::make<&Counter::get>(g_counter)(x);
+}
+
+// codegen: codegen_inline_lambda inlined 2
+int
+codegen_inline_lambda(int x)
+{
+    return IntDel{[](int v) { return v * 5; }}(x);
+}
+
+// Constant delegates with out of line targets, called directly.
+
+// codegen: codegen_direct_make_free direct_tail_call 1
+int
+codegen_direct_make_free(int x)
+{
+    return IntDel::make<extFree>()(x);
+}
+
+// Argument moved, object address loaded.
+// codegen: codegen_direct_make_member direct_tail_call 3
+int
+codegen_direct_make_member(int x)
+{
+    return IntDel::make<Ext, &Ext::add>(g_ext)(x);
+}
+
+// codegen: codegen_direct_make_fkn_ptr direct_tail_call 1
+int
+codegen_direct_make_fkn_ptr(int x)
+{
+    return IntDel::make(extFree)(x);
+}
+}
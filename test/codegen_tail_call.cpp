@@ -0,0 +1,92 @@
+/*
+ * codegen_tail_call.cpp
+ *
+ * Functions calling delegates of common signatures, compiled with -O2 and
+ * disassembled by cmake/check_codegen.cmake. Each call must compile to loads
+ * of the trampoline and the data pointer followed by a single indirect
+ * tail call 'jmp', no stack use and no other calls.
+ *
+ * The trampoline for a member function must be a direct 'jmp' to the member
+ * function, the data pointer argument already is the object pointer.
+ *
+ * Expectations are given as '<slashes> codegen: <symbol regex> <kind> [max]'.
+ */
+
+#include "delegate/delegate.hpp"
+
+namespace codegen
+{
+
+struct Msg
+{
+    int id;
+    unsigned char payload[64];
+};
+
+struct Obj
+{
+    int add(int x);
+    int m_val;
+};
+
+using IntDel = delegate<int(int)>;
+
+} // namespace codegen
+
+extern "C"
+{
+
+// codegen: codegen_call_void indirect_tail_call
+void
+codegen_call_void(delegate<void()> const& d)
+{
+    d();
+}
+
+// codegen: codegen_call_int indirect_tail_call
+int
+codegen_call_int(codegen::IntDel const& d, int x)
+{
+    return d(x);
+}
+
+// codegen: codegen_call_noexcept indirect_tail_call
+void
+codegen_call_noexcept(delegate<void(int) noexcept> const& d, int x) noexcept
+{
+    d(x);
+}
+
+// codegen: codegen_call_double indirect_tail_call
+double
+codegen_call_double(delegate<double(double, double)> const& d, double a,
+                    double b)
+{
+    return d(a, b);
+}
+
+// codegen: codegen_call_msg indirect_tail_call
+void
+codegen_call_msg(delegate<void(codegen::Msg const&)> const& d,
+                 codegen::Msg const& m)
+{
+    d(m);
+}
+
+// codegen: codegen_call_write indirect_tail_call
+bool
+codegen_call_write(delegate<bool(char const*, unsigned)> const& d,
+                   char const* data, unsigned len)
+{
+    return d(data, len);
+}
+
+// Instantiate the member trampoline checked by name.
+// codegen: .*doMemberCB.*3Obj.*3add.* direct_tail_call 1
+codegen::IntDel::Trampoline
+codegen_member_trampoline(codegen::Obj& o)
+{
+    return codegen::IntDel::make<codegen::Obj, &codegen::Obj::add>(o)
+        .trampoline();
+}
+}
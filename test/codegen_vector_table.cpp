@@ -0,0 +1,40 @@
+/*
+ * codegen_vector_table.cpp
+ *
+ * Interrupt handlers from delegate_vector_table, compiled with -O2 and
+ * disassembled by cmake/check_codegen.cmake. Each handler must compile to
+ * the loads of the trampoline and the data pointer from its slot followed
+ * by an indirect tail call, no stack use and no branches.
+ *
+ * Expectations are given as '<slashes> codegen: <symbol regex> <kind> [max]'.
+ */
+
+#include "delegate/delegate_vector_table.hpp"
+
+namespace codegen
+{
+
+struct Irq
+{
+};
+using Vectors = delegate_vector_table<4, Irq>;
+
+} // namespace codegen
+
+// codegen: codegen_irq0 indirect_tail_call 3
+DELEGATE_VECTOR_HANDLER(codegen::Vectors, 0, codegen_irq0)
+
+// codegen: codegen_irq3 indirect_tail_call 3
+DELEGATE_VECTOR_HANDLER(codegen::Vectors, 3, codegen_irq3)
+
+// Table of handlers, as placed in a hardware vector table. Instantiates
+// the handlers and the staging trampolines.
+// codegen: .*delegate_vector_table.*7handler.* indirect_tail_call 3
+// codegen: .*delegate_vector_table.*8doStaged.* indirect_tail_call 3
+extern "C" void
+codegen_bind(codegen::Vectors::Delegate d)
+{
+    codegen::Vectors::set<1>(d);
+}
+extern "C" codegen::Vectors::handler_array const codegen_vectors =
+    codegen::Vectors::handlers();
@@ -0,0 +1,223 @@
+#include "delegate/concurrent_signal.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Listener
+{
+    void onValue(int v)
+    {
+        m_sum.fetch_add(v, std::memory_order_relaxed);
+        m_calls.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::atomic<long> m_sum{0};
+    std::atomic<long> m_calls{0};
+};
+
+using Signal = concurrent_signal<void(int), 4, 8>;
+using Del = Signal::Delegate;
+
+// Count copies of arguments on the way to the listeners.
+struct Counted
+{
+    explicit Counted(int* copies) : m_copies(copies) {}
+    Counted(Counted const& o) : m_copies(o.m_copies)
+    {
+        ++*m_copies;
+    }
+    Counted(Counted&& o) noexcept : m_copies(o.m_copies) {}
+    int* m_copies;
+};
+
+struct CountedListener
+{
+    void on(Counted c)
+    {
+        calls += c.m_copies != nullptr;
+    }
+    int calls = 0;
+};
+
+} // namespace
+
+TEST(concurrent_signal, empty)
+{
+    Signal sig;
+    EXPECT_TRUE(sig.empty());
+    EXPECT_EQ(sig.size(), 0u);
+    EXPECT_EQ(Signal::capacity(), 4u);
+    auto e = sig.get_emitter();
+    ASSERT_TRUE(e.valid());
+    e(1);
+}
+
+TEST(concurrent_signal, subscribe_and_emit)
+{
+    Signal sig;
+    Listener a;
+    Listener b;
+    auto da = Del::make<Listener, &Listener::onValue>(a);
+    auto db = Del::make<Listener, &Listener::onValue>(b);
+    EXPECT_TRUE(sig.subscribe(da));
+    EXPECT_TRUE(sig.subscribe(db));
+    EXPECT_FALSE(sig.subscribe(Del{}));
+    EXPECT_EQ(sig.size(), 2u);
+    EXPECT_TRUE(sig.snapshot().contains(db));
+
+    auto e = sig.get_emitter();
+    e(3);
+    EXPECT_EQ(a.m_sum, 3);
+    EXPECT_EQ(b.m_sum, 3);
+
+    EXPECT_TRUE(sig.unsubscribe(da));
+    EXPECT_FALSE(sig.unsubscribe(da));
+    e(4);
+    EXPECT_EQ(a.m_sum, 3);
+    EXPECT_EQ(b.m_sum, 7);
+
+    sig.clear();
+    EXPECT_TRUE(sig.empty());
+    e(5);
+    EXPECT_EQ(b.m_sum, 7);
+}
+
+TEST(concurrent_signal, capacity)
+{
+    Signal sig;
+    Listener l[5];
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(sig.subscribe(Del::make<Listener, &Listener::onValue>(l[i])));
+    EXPECT_FALSE(sig.subscribe(Del::make<Listener, &Listener::onValue>(l[4])));
+    EXPECT_EQ(sig.size(), 4u);
+}
+
+TEST(concurrent_signal, emitter_slots)
+{
+    Signal sig;
+    std::vector<Signal::emitter> emitters;
+    for (int i = 0; i < 8; ++i)
+    {
+        emitters.push_back(sig.get_emitter());
+        EXPECT_TRUE(emitters.back().valid());
+    }
+    Signal::emitter extra = sig.get_emitter();
+    EXPECT_FALSE(extra);
+
+    // Released slots are claimed again.
+    emitters.pop_back();
+    extra = sig.get_emitter();
+    EXPECT_TRUE(extra);
+
+    Signal::emitter moved = std::move(extra);
+    EXPECT_TRUE(moved);
+    EXPECT_FALSE(extra);
+}
+
+TEST(concurrent_signal, invalid_emitter_is_noop)
+{
+    Signal sig;
+    Listener a;
+    sig.subscribe(Del::make<Listener, &Listener::onValue>(a));
+    Signal::emitter none;
+    EXPECT_FALSE(none);
+    none(1);
+    EXPECT_EQ(a.m_calls, 0);
+}
+
+TEST(concurrent_signal, argument_copies)
+{
+    concurrent_signal<void(Counted), 4, 2> sig;
+    CountedListener a;
+    CountedListener b;
+    using D = delegate<void(Counted)>;
+    sig.subscribe(D::make<CountedListener, &CountedListener::on>(a));
+    sig.subscribe(D::make<CountedListener, &CountedListener::on>(b));
+    auto e = sig.get_emitter();
+
+    int copies = 0;
+    Counted const arg{&copies};
+    e(arg);
+    EXPECT_EQ(a.calls, 1);
+    EXPECT_EQ(b.calls, 1);
+    // Into the call, then one per listener.
+    EXPECT_EQ(copies, 3);
+}
+
+// Subscribers change the list while emitters run. Each emit must see a
+// consistent snapshot: the permanent listener always called once.
+TEST(concurrent_signal, emit_while_subscribing)
+{
+    Signal sig;
+    Listener permanent;
+    Listener toggled;
+    auto dp = Del::make<Listener, &Listener::onValue>(permanent);
+    auto dt = Del::make<Listener, &Listener::onValue>(toggled);
+    sig.subscribe(dp);
+
+    constexpr int kEmitters = 3;
+    constexpr long kEmits = 20000;
+    std::atomic<int> done{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kEmitters; ++t)
+    {
+        threads.emplace_back([&] {
+            auto e = sig.get_emitter();
+            for (long i = 0; i < kEmits; ++i)
+            {
+                e(1);
+                if (i % 64 == 0)
+                    std::this_thread::yield();
+            }
+            done.fetch_add(1);
+        });
+    }
+    while (done.load() != kEmitters)
+    {
+        sig.subscribe(dt);
+        std::this_thread::yield();
+        sig.unsubscribe(dt);
+        std::this_thread::yield();
+    }
+    for (auto& t : threads)
+        t.join();
+
+    EXPECT_EQ(permanent.m_calls, kEmitters * kEmits);
+    EXPECT_LE(toggled.m_calls, kEmitters * kEmits);
+}
+
+// After unsubscribe and synchronize, the removed listener is not called.
+TEST(concurrent_signal, synchronize)
+{
+    Signal sig;
+    Listener l;
+    auto d = Del::make<Listener, &Listener::onValue>(l);
+    sig.subscribe(d);
+
+    std::atomic<bool> stop{false};
+    std::thread emitterThread([&] {
+        auto e = sig.get_emitter();
+        while (!stop.load())
+        {
+            e(1);
+            std::this_thread::yield();
+        }
+    });
+    while (l.m_calls.load() == 0)
+        std::this_thread::yield();
+
+    sig.unsubscribe(d);
+    sig.synchronize();
+    long const calls = l.m_calls.load();
+    for (int i = 0; i < 100; ++i)
+        std::this_thread::yield();
+    EXPECT_EQ(l.m_calls.load(), calls);
+
+    stop = true;
+    emitterThread.join();
+}
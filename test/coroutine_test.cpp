@@ -0,0 +1,177 @@
+#include "delegate/coroutine.hpp"
+
+#include <coroutine>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+int s_allocations = 0;
+
+// Minimal eagerly started coroutine type, frame destroyed at completion.
+struct task
+{
+    struct promise_type
+    {
+        task get_return_object() noexcept
+        {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception()
+        {
+            std::abort();
+        }
+    };
+};
+
+// Fake async API, stores the completion until the test calls it.
+delegate<void(int)> s_pendingInt;
+delegate<void(std::string)> s_pendingString;
+delegate<void()> s_pendingVoid;
+
+void
+asyncRead(delegate<void(int)> done)
+{
+    s_pendingInt = done;
+}
+
+task
+reader(int& out, int& step)
+{
+    step = 1;
+    out = co_await async_completion<void(int)>(
+        [](delegate<void(int)> done) { asyncRead(done); });
+    step = 2;
+    out += co_await async_completion<void(int)>(
+        [](delegate<void(int)> done) { asyncRead(done); });
+    step = 3;
+}
+
+} // namespace
+
+void*
+operator new(std::size_t n)
+{
+    ++s_allocations;
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+TEST(coroutine, completion_resumes_with_result)
+{
+    int out = 0;
+    int step = 0;
+    reader(out, step);
+    EXPECT_EQ(step, 1);
+    ASSERT_FALSE(s_pendingInt.null());
+
+    int const allocs = s_allocations;
+    auto done = s_pendingInt;
+    s_pendingInt.clear();
+    done(40);
+    EXPECT_EQ(step, 2);
+    EXPECT_EQ(out, 40);
+
+    done = s_pendingInt;
+    done(2);
+    EXPECT_EQ(step, 3);
+    EXPECT_EQ(out, 42);
+    // Suspending and resuming did not allocate.
+    EXPECT_EQ(s_allocations, allocs);
+}
+
+TEST(coroutine, synchronous_completion_does_not_suspend)
+{
+    int out = 0;
+    [](int& o) -> task {
+        o = co_await async_completion<void(int)>(
+            [](delegate<void(int)> done) { done(7); });
+    }(out);
+    EXPECT_EQ(out, 7);
+}
+
+TEST(coroutine, non_trivial_result)
+{
+    std::string out;
+    [](std::string& o) -> task {
+        o = co_await async_completion<void(std::string)>(
+            [](delegate<void(std::string)> done) { s_pendingString = done; });
+    }(out);
+    EXPECT_TRUE(out.empty());
+    s_pendingString("a string long enough to not fit in the object");
+    EXPECT_EQ(out, "a string long enough to not fit in the object");
+}
+
+TEST(coroutine, void_completion_and_resume_delegate)
+{
+    int step = 0;
+    [](int& s) -> task {
+        co_await async_completion<void()>(
+            [](delegate<void()> done) { s_pendingVoid = done; });
+        s = 1;
+        // Plain resume of the frame.
+        struct Park
+        {
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+            void await_suspend(std::coroutine_handle<> h) noexcept
+            {
+                s_pendingVoid = resume_delegate(h);
+            }
+            void await_resume() const noexcept {}
+        };
+        co_await Park{};
+        s = 2;
+    }(step);
+    EXPECT_EQ(step, 0);
+    s_pendingVoid();
+    EXPECT_EQ(step, 1);
+    s_pendingVoid();
+    EXPECT_EQ(step, 2);
+}
+
+TEST(coroutine, completion_from_other_thread)
+{
+    for (int i = 0; i < 200; ++i)
+    {
+        std::atomic<int> out{0};
+        std::thread t;
+        [](std::atomic<int>& o, std::thread& th, int v) -> task {
+            o = co_await async_completion<void(int)>(
+                [&th, v](delegate<void(int)> done) {
+                    th = std::thread([done, v] { done(v); });
+                });
+        }(out, t, i + 1);
+        t.join();
+        EXPECT_EQ(out.load(), i + 1);
+    }
+}
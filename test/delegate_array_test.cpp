@@ -0,0 +1,150 @@
+namespace test_ns
+{
+#include "delegate/delegate_array.hpp"
+}
+
+using test_ns::delegate;
+using test_ns::delegate_array;
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Timer
+{
+    void onTick(int x)
+    {
+        sum += x;
+    }
+    void onTickConst(int x) const
+    {
+        constSum += x;
+    }
+    int sum = 0;
+    mutable int constSum = 0;
+};
+
+int s_freeSum = 0;
+
+void
+freeTick(int x)
+{
+    s_freeSum += x;
+}
+
+using Del = delegate<void(int)>;
+
+} // namespace
+
+TEST(delegate_array, push_back_and_invoke_all)
+{
+    delegate_array<void(int), 4> arr;
+    EXPECT_TRUE(arr.empty());
+    EXPECT_EQ(arr.capacity(), 4u);
+
+    Timer t1;
+    Timer t2;
+    s_freeSum = 0;
+    EXPECT_TRUE(arr.push_back(Del::make<Timer, &Timer::onTick>(t1)));
+    EXPECT_TRUE(arr.push_back(Del::make<freeTick>()));
+    EXPECT_TRUE(arr.push_back(Del::make<Timer, &Timer::onTickConst>(t2)));
+    EXPECT_FALSE(arr.push_back(Del{}));
+    EXPECT_EQ(arr.size(), 3u);
+
+    arr.invoke_all(2);
+    EXPECT_EQ(t1.sum, 2);
+    EXPECT_EQ(t2.constSum, 2);
+    EXPECT_EQ(s_freeSum, 2);
+
+    EXPECT_TRUE(arr.push_back(Del::make(freeTick)));
+    EXPECT_TRUE(arr.full());
+    EXPECT_FALSE(arr.push_back(Del::make<freeTick>()));
+
+    arr.invoke_all(1);
+    EXPECT_EQ(s_freeSum, 4);
+
+    EXPECT_TRUE(arr[0] == (Del::make<Timer, &Timer::onTick>(t1)));
+    EXPECT_TRUE(arr[3] == Del::make(freeTick));
+
+    arr.clear();
+    EXPECT_TRUE(arr.empty());
+}
+
+TEST(delegate_array, erase_moves_last)
+{
+    delegate_array<void(int), 4> arr;
+    Timer t[3];
+    for (auto& ti : t)
+        arr.push_back(Del::make<Timer, &Timer::onTick>(ti));
+
+    EXPECT_TRUE(arr.erase(0));
+    EXPECT_FALSE(arr.erase(2));
+    EXPECT_EQ(arr.size(), 2u);
+    EXPECT_TRUE(arr[0] == (Del::make<Timer, &Timer::onTick>(t[2])));
+
+    arr.invoke_all(1);
+    EXPECT_EQ(t[0].sum, 0);
+    EXPECT_EQ(t[1].sum, 1);
+    EXPECT_EQ(t[2].sum, 1);
+}
+
+TEST(delegate_array, sort_by_trampoline_groups_targets)
+{
+    delegate_array<void(int), 64> arr;
+    Timer t[60];
+    s_freeSum = 0;
+    for (int i = 0; i < 60; ++i)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            arr.push_back(Del::make<Timer, &Timer::onTick>(t[i]));
+            break;
+        case 1:
+            arr.push_back(Del::make<Timer, &Timer::onTickConst>(t[i]));
+            break;
+        default:
+            arr.push_back(Del::make<freeTick>());
+            break;
+        }
+    }
+    EXPECT_FALSE(arr.sorted_by_trampoline());
+    arr.sort_by_trampoline();
+    EXPECT_TRUE(arr.sorted_by_trampoline());
+    EXPECT_EQ(arr.size(), 60u);
+
+    // Each trampoline form one contiguous run.
+    int runs = 1;
+    for (unsigned i = 1; i < arr.size(); ++i)
+    {
+        if (!(arr[i].trampoline() == arr[i - 1].trampoline()))
+            ++runs;
+    }
+    EXPECT_EQ(runs, 3);
+
+    // Data pointers moved along with their trampolines.
+    arr.invoke_all(1);
+    for (int i = 0; i < 60; ++i)
+    {
+        EXPECT_EQ(t[i].sum, i % 3 == 0 ? 1 : 0);
+        EXPECT_EQ(t[i].constSum, i % 3 == 1 ? 1 : 0);
+    }
+    EXPECT_EQ(s_freeSum, 20);
+}
+
+TEST(delegate_array, value_arguments_copied_for_each_call)
+{
+    delegate_array<void(std::string), 2> arr;
+    std::string a;
+    std::string b;
+    auto la = [&a](std::string s) { a = std::move(s); };
+    auto lb = [&b](std::string s) { b = std::move(s); };
+    arr.push_back(delegate<void(std::string)>::make(la));
+    arr.push_back(delegate<void(std::string)>::make(lb));
+    arr.invoke_all("a long string, not using small string optimization");
+    EXPECT_EQ(a, "a long string, not using small string optimization");
+    EXPECT_EQ(b, a);
+}
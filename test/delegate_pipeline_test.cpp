@@ -0,0 +1,125 @@
+#include "delegate/delegate_pipeline.hpp"
+
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Decoder
+{
+    int decode(int raw)
+    {
+        ++calls;
+        return raw * 10;
+    }
+    int calls = 0;
+};
+
+struct Validator
+{
+    bool validate(int v) const
+    {
+        return v < limit;
+    }
+    int limit = 100;
+};
+
+struct Router
+{
+    int route(bool valid)
+    {
+        valid ? ++accepted : ++rejected;
+        return accepted;
+    }
+    int accepted = 0;
+    int rejected = 0;
+};
+
+int
+addOne(int x)
+{
+    return x + 1;
+}
+
+int
+twice(int x)
+{
+    return 2 * x;
+}
+
+int s_ticks = 0;
+
+void
+tick()
+{
+    ++s_ticks;
+}
+
+} // namespace
+
+TEST(delegate_pipeline, three_objects)
+{
+    Decoder dec;
+    Validator val;
+    Router router;
+    auto p = compose<&Decoder::decode, &Validator::validate, &Router::route>(
+        dec, val, router);
+    static_assert(std::is_same<decltype(p)::Signature, int(int)>::value,
+                  "first stage parameters, last stage result");
+    static_assert(decltype(p)::objects == 3, "");
+    delegate<int(int)> d = p.view();
+    EXPECT_EQ(d(5), 1);
+    EXPECT_EQ(d(50), 1);
+    EXPECT_EQ(d(3), 2);
+    EXPECT_EQ(dec.calls, 3);
+    EXPECT_EQ(router.rejected, 1);
+
+    // Direct call without trampoline.
+    EXPECT_EQ(p(1), 3);
+}
+
+TEST(delegate_pipeline, free_functions)
+{
+    auto p = compose<&addOne, &twice, &addOne>();
+    static_assert(decltype(p)::objects == 0, "");
+    auto d = p.view();
+    EXPECT_EQ(d(3), 9);
+    EXPECT_EQ(d.target_object(), nullptr);
+    static_assert(std::is_trivially_copyable<decltype(p)>::value, "");
+}
+
+TEST(delegate_pipeline, one_object_view_independent)
+{
+    Decoder dec;
+    delegate<int(int)> d;
+    {
+        auto p = compose<&addOne, &Decoder::decode, &twice>(dec);
+        d = p.view();
+        EXPECT_EQ(d.target_object(), &dec);
+    }
+    // Refers to the object, not the pipeline.
+    EXPECT_EQ(d(1), 40);
+    EXPECT_EQ(dec.calls, 1);
+}
+
+TEST(delegate_pipeline, const_object)
+{
+    Validator const val{};
+    Router router;
+    auto p = compose<&Validator::validate, &Router::route>(val, router);
+    auto d = p.view();
+    d(200);
+    d(20);
+    EXPECT_EQ(router.accepted, 1);
+    EXPECT_EQ(router.rejected, 1);
+}
+
+TEST(delegate_pipeline, void_stage)
+{
+    auto p = compose<&tick, &tick>();
+    s_ticks = 0;
+    p.view()();
+    EXPECT_EQ(s_ticks, 2);
+}
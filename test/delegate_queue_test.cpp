@@ -0,0 +1,172 @@
+#include "delegate/delegate_queue.hpp"
+
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Recorder
+{
+    void onValue(int v)
+    {
+        values.push_back(v);
+    }
+    void onPair(int a, char b)
+    {
+        sum += a + b;
+    }
+    std::vector<int> values;
+    int sum = 0;
+};
+
+int s_calls = 0;
+
+void
+freeCall()
+{
+    ++s_calls;
+}
+
+using IntDel = delegate<void(int)>;
+
+template <typename Mode>
+class delegate_queue_test : public ::testing::Test
+{
+};
+
+using Modes = ::testing::Types<queue_spsc, queue_mpsc>;
+
+} // namespace
+
+TYPED_TEST_SUITE(delegate_queue_test, Modes);
+
+TYPED_TEST(delegate_queue_test, push_drain_in_order)
+{
+    delegate_queue<void(int), 4, TypeParam> q;
+    Recorder r;
+    auto d = IntDel::make<Recorder, &Recorder::onValue>(r);
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(q.capacity(), 4u);
+
+    EXPECT_TRUE(q.push(d, 1));
+    EXPECT_TRUE(q.push(d, 2));
+    EXPECT_TRUE(q.push(d, 3));
+    EXPECT_TRUE(q.push(d, 4));
+    EXPECT_FALSE(q.push(d, 5));
+    EXPECT_EQ(q.size(), 4u);
+
+    EXPECT_EQ(q.drain(2), 2u);
+    EXPECT_EQ(r.values, (std::vector<int>{1, 2}));
+
+    // Wrap around.
+    EXPECT_TRUE(q.push(d, 5));
+    EXPECT_TRUE(q.push(d, 6));
+    EXPECT_EQ(q.drain(), 4u);
+    EXPECT_EQ(r.values, (std::vector<int>{1, 2, 3, 4, 5, 6}));
+    EXPECT_EQ(q.drain(), 0u);
+    EXPECT_TRUE(q.empty());
+}
+
+TYPED_TEST(delegate_queue_test, multiple_and_no_arguments)
+{
+    delegate_queue<void(int, char), 8, TypeParam> q;
+    Recorder r;
+    q.push(delegate<void(int, char)>::make<Recorder, &Recorder::onPair>(r), 1,
+           'a');
+    q.push(delegate<void(int, char)>{}, 2, 'b'); // Null, does nothing.
+    EXPECT_EQ(q.drain(), 2u);
+    EXPECT_EQ(r.sum, 1 + 'a');
+
+    delegate_queue<void(), 8, TypeParam> vq;
+    s_calls = 0;
+    vq.push(delegate<void()>::make<freeCall>());
+    vq.push(delegate<void()>::make<freeCall>());
+    EXPECT_EQ(vq.drain(), 2u);
+    EXPECT_EQ(s_calls, 2);
+}
+
+TYPED_TEST(delegate_queue_test, two_threads)
+{
+    static delegate_queue<void(int), 64, TypeParam> q;
+    struct Checker
+    {
+        void onValue(int v)
+        {
+            if (v != next)
+                bad++;
+            next = v + 1;
+        }
+        int next = 0;
+        int bad = 0;
+    } c;
+    constexpr int count = 100000;
+    std::thread producer([&c] {
+        auto d = IntDel::make<Checker, &Checker::onValue>(c);
+        for (int i = 0; i < count;)
+        {
+            if (q.push(d, i))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+    int called = 0;
+    while (called < count)
+    {
+        int const n = static_cast<int>(q.drain(16));
+        if (n == 0)
+            std::this_thread::yield();
+        called += n;
+    }
+    producer.join();
+    EXPECT_EQ(c.next, count);
+    EXPECT_EQ(c.bad, 0);
+}
+
+TEST(delegate_queue, mpsc_many_producers)
+{
+    static delegate_queue<void(int), 256, queue_mpsc> q;
+    constexpr int producers = 4;
+    constexpr int perProducer = 20000;
+    struct Counter
+    {
+        void onValue(int v)
+        {
+            // Values from each producer arrive in order.
+            int const p = v / perProducer;
+            if (v % perProducer != next[p])
+                bad++;
+            next[p]++;
+            total++;
+        }
+        int next[producers] = {};
+        int bad = 0;
+        int total = 0;
+    } c;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&c, p] {
+            auto d = IntDel::make<Counter, &Counter::onValue>(c);
+            for (int i = 0; i < perProducer;)
+            {
+                if (q.push(d, p * perProducer + i))
+                    ++i;
+            }
+        });
+    }
+    while (c.total < producers * perProducer)
+    {
+        if (q.drain(32) == 0)
+            std::this_thread::yield();
+    }
+    for (auto& t : threads)
+        t.join();
+    EXPECT_EQ(c.bad, 0);
+    EXPECT_TRUE(q.empty());
+}
@@ -0,0 +1,116 @@
+namespace test_ns
+{
+#include "delegate/delegate_ref.hpp"
+}
+
+using test_ns::delegate;
+using test_ns::delegate_ref;
+
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+int
+freeFkn(int x)
+{
+    return x + 5;
+}
+
+struct Obj
+{
+    int member(int x)
+    {
+        return x + m_val;
+    }
+    int m_val = 10;
+};
+
+// Functor with state, changed by each call.
+struct Counting
+{
+    int operator()(int x)
+    {
+        return x * ++n;
+    }
+    int n = 0;
+};
+
+// An API taking a callback without being a template.
+int
+sumMapped(std::vector<int> const& v, delegate_ref<int(int)> f)
+{
+    int sum = 0;
+    for (int x : v)
+        sum += f(x);
+    return sum;
+}
+
+} // namespace
+
+TEST(delegate_ref, is_two_words)
+{
+    using Ref = delegate_ref<int(int)>;
+    EXPECT_EQ(sizeof(Ref), 2 * sizeof(void*));
+    EXPECT_TRUE(std::is_trivially_copyable<Ref>::value);
+}
+
+TEST(delegate_ref, accepts_temporaries)
+{
+    std::vector<int> v{1, 2, 3};
+    EXPECT_EQ(sumMapped(v, [](int x) { return x * 2; }), 12);
+
+    int offset = 100;
+    EXPECT_EQ(sumMapped(v, [&offset](int x) { return x + offset; }), 306);
+
+    // Mutable temporary, state kept during the call.
+    EXPECT_EQ(sumMapped(v, Counting{}), 14);
+}
+
+TEST(delegate_ref, accepts_lvalues_delegates_and_functions)
+{
+    std::vector<int> v{1, 2};
+    auto lambda = [](int x) { return x * 3; };
+    auto const clambda = [](int x) { return x * 4; };
+    EXPECT_EQ(sumMapped(v, lambda), 9);
+    EXPECT_EQ(sumMapped(v, clambda), 12);
+
+    EXPECT_EQ(sumMapped(v, freeFkn), 13);
+    EXPECT_EQ(sumMapped(v, &freeFkn), 13);
+
+    Obj o;
+    auto del = delegate<int(int)>::make<Obj, &Obj::member>(o);
+    EXPECT_EQ(sumMapped(v, del), 23);
+    EXPECT_EQ(sumMapped(v, delegate<int(int)>::make<freeFkn>()), 13);
+
+    delegate_ref<int(int)> ref{del};
+    delegate_ref<int(int)> copy{ref};
+    EXPECT_EQ(copy(1), 11);
+}
+
+TEST(delegate_ref, null)
+{
+    delegate_ref<int(int)> ref{nullptr};
+    EXPECT_TRUE(ref.null());
+    EXPECT_FALSE(ref);
+    EXPECT_EQ(ref(1), 0);
+
+    delegate_ref<int(int)> ref2{delegate<int(int)>{}};
+    EXPECT_TRUE(ref2.null());
+    delegate_ref<void(int)> ref3{[](int) {}};
+    EXPECT_TRUE(ref3);
+    ref3(1);
+}
+
+#ifdef DELEGATE_NOEXCEPT_TYPES
+TEST(delegate_ref, noexcept_signature)
+{
+    auto call = [](delegate_ref<int(int) noexcept> f) noexcept { return f(2); };
+    EXPECT_EQ(call([](int x) noexcept { return x * 5; }), 10);
+    static_assert(noexcept(std::declval<delegate_ref<int(int) noexcept>>()(1)),
+                  "noexcept signature");
+}
+#endif
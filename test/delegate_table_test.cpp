@@ -0,0 +1,129 @@
+#include "delegate/delegate_table.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+int
+opAdd(int x)
+{
+    return x + 1;
+}
+
+int
+opSub(int x)
+{
+    return x - 1;
+}
+
+int
+opMul(int x)
+{
+    return x * 2;
+}
+
+struct Device
+{
+    int scale(int x) const
+    {
+        return x * m_factor;
+    }
+    int count(int)
+    {
+        return ++m_count;
+    }
+    int m_factor = 10;
+    int m_count = 0;
+};
+
+Device s_dev;
+
+enum class Op : unsigned char
+{
+    add = 1,
+    sub = 2,
+    mul = 3,
+    scale = 5,
+};
+
+using Del = delegate<int(int)>;
+
+using DenseTable =
+    delegate_table<int(int), table_entry<Op::add, &opAdd>,
+                   table_entry<Op::sub, &opSub>, table_entry<Op::mul, &opMul>,
+                   table_entry<Op::scale, &Device::scale, &s_dev>>;
+
+using SparseTable =
+    delegate_table<int(int), table_entry<0x10, &opAdd>,
+                   table_entry<0x1234, &opSub>, table_entry<-7, &opMul>,
+                   table_entry<1000000, &Device::count, &s_dev>,
+                   table_entry<77, &Device::scale, &s_dev>>;
+
+} // namespace
+
+TEST(delegate_table, dense_keys)
+{
+    static_assert(DenseTable::dense, "");
+    EXPECT_EQ(DenseTable::size(), 4u);
+    EXPECT_EQ(DenseTable::slots(), 5u);
+
+    EXPECT_EQ(DenseTable::call(Op::add, 3), 4);
+    EXPECT_EQ(DenseTable::call(Op::sub, 3), 2);
+    EXPECT_EQ(DenseTable::call(Op::mul, 3), 6);
+    EXPECT_EQ(DenseTable::call(Op::scale, 3), 30);
+
+    // Hole in the key range and keys outside of it.
+    EXPECT_FALSE(DenseTable::contains(static_cast<Op>(4)));
+    EXPECT_EQ(DenseTable::call(static_cast<Op>(4), 3), 0);
+    EXPECT_EQ(DenseTable::call(static_cast<Op>(0), 3), 0);
+    EXPECT_EQ(DenseTable::call(static_cast<Op>(200), 3), 0);
+    EXPECT_TRUE(DenseTable::find(static_cast<Op>(0)).null());
+}
+
+TEST(delegate_table, sparse_keys)
+{
+    static_assert(!SparseTable::dense, "");
+    EXPECT_EQ(SparseTable::size(), 5u);
+    EXPECT_GE(SparseTable::slots(), 5u);
+
+    EXPECT_EQ(SparseTable::call(0x10, 3), 4);
+    EXPECT_EQ(SparseTable::call(0x1234, 3), 2);
+    EXPECT_EQ(SparseTable::call(-7, 3), 6);
+    EXPECT_EQ(SparseTable::call(77, 3), 30);
+    int before = s_dev.m_count;
+    EXPECT_EQ(SparseTable::call(1000000, 0), before + 1);
+
+    for (int k : {0, 1, 0x11, 0x1233, -6, 76, 999999})
+    {
+        EXPECT_FALSE(SparseTable::contains(k)) << k;
+        EXPECT_EQ(SparseTable::call(k, 3), 0) << k;
+    }
+}
+
+TEST(delegate_table, lookup_at_compile_time)
+{
+    static_assert(DenseTable::find(Op::add) == Del::make<opAdd>(), "");
+    static_assert(DenseTable::find(Op::scale) ==
+                      Del::make<&Device::scale>(s_dev),
+                  "");
+    static_assert(SparseTable::find(-7) == Del::make<opMul>(), "");
+    static_assert(SparseTable::find(8).null(), "");
+    static_assert(SparseTable::contains(0x1234), "");
+}
+
+TEST(delegate_table, many_sparse_keys)
+{
+    using T = delegate_table<
+        int(int), table_entry<3u, &opAdd>, table_entry<17u, &opAdd>,
+        table_entry<256u, &opAdd>, table_entry<4096u, &opAdd>,
+        table_entry<65535u, &opAdd>, table_entry<65536u, &opSub>,
+        table_entry<1000u, &opSub>, table_entry<12345678u, &opMul>,
+        table_entry<0xffffffffu, &opMul>>;
+    static_assert(!T::dense, "");
+    EXPECT_EQ(T::call(3u, 1), 2);
+    EXPECT_EQ(T::call(65536u, 1), 0);
+    EXPECT_EQ(T::call(0xffffffffu, 4), 8);
+    EXPECT_EQ(T::call(12345678u, 5), 10);
+    EXPECT_EQ(T::call(4u, 5), 0);
+}
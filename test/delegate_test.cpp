@@ -7,6 +7,8 @@ using test_ns::delegate;
 using test_ns::mem_fkn;
 
 #include <functional>
+#include <type_traits>
+#include <utility>
 
 #include <cassert>
 #include <cstdint>
@@ -880,6 +882,137 @@ TEST(delegate, special_case_that_should_work_uniqueptr)
     EXPECT_EQ(*up, 12);
 }
 
+static int
+derefUniquePtr(std::unique_ptr<int> p)
+{
+    return *p;
+}
+
+TEST(delegate, move_only_argument)
+{
+    delegate<int(std::unique_ptr<int>)> del;
+    EXPECT_EQ(del(std::unique_ptr<int>{new int{3}}), 0);
+
+    del.set<derefUniquePtr>();
+    EXPECT_EQ(del(std::unique_ptr<int>{new int{4}}), 4);
+
+    auto lam = [](std::unique_ptr<int> p) -> int { return *p + 1; };
+    del.set(lam);
+    std::unique_ptr<int> up{new int{5}};
+    EXPECT_EQ(del(std::move(up)), 6);
+    EXPECT_EQ(up, nullptr);
+}
+
+// Count number of copies/moves done on the way to the target.
+struct CopyCount
+{
+    CopyCount() = default;
+    CopyCount(CopyCount const&)
+    {
+        copies++;
+    }
+    CopyCount(CopyCount&&)
+    {
+        moves++;
+    }
+    static void reset()
+    {
+        copies = 0;
+        moves = 0;
+    }
+    static int copies;
+    static int moves;
+};
+
+int CopyCount::copies = 0;
+int CopyCount::moves = 0;
+
+struct CopyCheck
+{
+    void member(CopyCount) {}
+    void cmember(CopyCount) const {}
+    void operator()(CopyCount) {}
+    void ref(CopyCount const&) {}
+};
+
+static void
+freeCopyCheck(CopyCount)
+{
+}
+
+static void
+freeCopyCheckWithVoid(void*, CopyCount)
+{
+}
+
+static void
+freeCopyCheckWithObject(CopyCheck&, CopyCount)
+{
+}
+
+// Pass the delegate an lvalue. Expect a single copy into the delegate
+// call operator and a single move into the target.
+static void
+expectCopyOnceMoveOnce(delegate<void(CopyCount)> del)
+{
+    CopyCount c;
+    CopyCount::reset();
+    del(c);
+    EXPECT_EQ(CopyCount::copies, 1);
+    EXPECT_EQ(CopyCount::moves, 1);
+
+    CopyCount::reset();
+    del(CopyCount{});
+    EXPECT_EQ(CopyCount::copies, 0);
+    EXPECT_EQ(CopyCount::moves, 1);
+}
+
+TEST(delegate, arguments_are_forwarded_to_target)
+{
+    using Del = delegate<void(CopyCount)>;
+    CopyCheck cc;
+    CopyCheck const ccc;
+
+    expectCopyOnceMoveOnce(Del::make<freeCopyCheck>());
+    expectCopyOnceMoveOnce(Del::make<CopyCheck, &CopyCheck::member>(cc));
+    expectCopyOnceMoveOnce(Del::make<CopyCheck, &CopyCheck::cmember>(ccc));
+    expectCopyOnceMoveOnce(Del::make(cc));
+    expectCopyOnceMoveOnce(Del::make(freeCopyCheck));
+    expectCopyOnceMoveOnce(
+        Del::make_free_with_void<freeCopyCheckWithVoid>(nullptr));
+    expectCopyOnceMoveOnce(
+        Del::make_free_with_object<CopyCheck, freeCopyCheckWithObject>(cc));
+
+    auto mf = mem_fkn<CopyCheck, false, void(CopyCount)>::make<
+        &CopyCheck::member>();
+    expectCopyOnceMoveOnce(Del::make(mf, cc));
+
+    CopyCount c;
+    CopyCount::reset();
+    mf.invoke(cc, c);
+    EXPECT_EQ(CopyCount::copies, 1);
+    EXPECT_EQ(CopyCount::moves, 1);
+
+    // Null delegate must not touch the argument beyond the call operator.
+    CopyCount::reset();
+    Del{}(c);
+    EXPECT_EQ(CopyCount::copies, 1);
+    EXPECT_EQ(CopyCount::moves, 0);
+}
+
+TEST(delegate, reference_arguments_are_not_copied)
+{
+    CopyCheck cc;
+    auto del =
+        delegate<void(CopyCount const&)>::make<CopyCheck, &CopyCheck::ref>(cc);
+
+    CopyCount c;
+    CopyCount::reset();
+    del(c);
+    EXPECT_EQ(CopyCount::copies, 0);
+    EXPECT_EQ(CopyCount::moves, 0);
+}
+
 #include <set>
 
 static int
@@ -902,6 +1035,301 @@ TEST(delegate, can_store_in_a_set)
     EXPECT_EQ(testSet.size(), 2u);
 }
 
+// delegate.hpp is included in test_ns, tell hash.hpp about it.
+#define DELEGATE_NAMESPACE test_ns
+#include "delegate/hash.hpp"
+
+#include <unordered_set>
+
+TEST(delegate, can_store_in_an_unordered_set)
+{
+    using Del = delegate<int(int)>;
+    MemberCheck mc;
+    MemberCheck mc2;
+
+    std::unordered_set<Del> testSet;
+    EXPECT_TRUE(testSet.insert(Del{}).second);
+    EXPECT_TRUE(testSet.insert(Del::make<freeFkn>()).second);
+    EXPECT_TRUE(testSet.insert(Del::make<freeFkn2>()).second);
+    EXPECT_TRUE(
+        testSet.insert(Del::make<MemberCheck, &MemberCheck::member>(mc)).second);
+    EXPECT_TRUE(
+        testSet.insert(Del::make<MemberCheck, &MemberCheck::member>(mc2))
+            .second);
+    // Runtime function pointers are stored in the other union member.
+    EXPECT_TRUE(testSet.insert(Del::make(freeFkn)).second);
+    EXPECT_TRUE(testSet.insert(Del::make(freeFkn2)).second);
+    EXPECT_EQ(testSet.size(), 7u);
+
+    // Duplicates are detected.
+    EXPECT_FALSE(testSet.insert(Del{}).second);
+    EXPECT_FALSE(testSet.insert(Del::make<freeFkn>()).second);
+    EXPECT_FALSE(
+        testSet.insert(Del::make<MemberCheck, &MemberCheck::member>(mc2))
+            .second);
+    EXPECT_FALSE(testSet.insert(Del::make(freeFkn2)).second);
+    EXPECT_EQ(testSet.size(), 7u);
+
+    EXPECT_EQ(testSet.erase(Del::make(freeFkn)), 1u);
+    EXPECT_EQ(testSet.erase(Del::make<MemberCheck, &MemberCheck::member>(mc)),
+              1u);
+    EXPECT_EQ(testSet.size(), 5u);
+
+    // Can also use the member functor directly.
+    std::unordered_set<Del, Del::Hash, Del::Equal> testSet2;
+    testSet2.insert(Del::make<freeFkn>());
+    testSet2.insert(Del::make<freeFkn>());
+    EXPECT_EQ(testSet2.size(), 1u);
+}
+
+TEST(delegate, hash_is_consistent_with_equal)
+{
+    using Del = delegate<int(int)>;
+    MemberCheck mc;
+    EXPECT_EQ(Del::hash(Del{}), Del::hash(Del{nullptr}));
+    EXPECT_EQ(Del::hash(Del::make(freeFkn)), Del::hash(Del::make(freeFkn)));
+    EXPECT_EQ(Del::hash(Del::make<MemberCheck, &MemberCheck::member>(mc)),
+              Del::hash(Del::make<MemberCheck, &MemberCheck::member>(mc)));
+    EXPECT_EQ(std::hash<Del>{}(Del::make<freeFkn>()),
+              Del::hash(Del::make<freeFkn>()));
+}
+
+TEST(delegate, target_object)
+{
+    using Del = delegate<int(int)>;
+    MemberCheck mc;
+    auto lambda = [](int x) { return x; };
+    EXPECT_EQ(Del{}.target_object(), nullptr);
+    EXPECT_EQ(Del::make<freeFkn>().target_object(), nullptr);
+    EXPECT_EQ(Del::make(freeFkn).target_object(), nullptr);
+    EXPECT_EQ((Del::make<MemberCheck, &MemberCheck::member>(mc).target_object()),
+              &mc);
+    EXPECT_EQ(Del::make(lambda).target_object(), &lambda);
+}
+
+TEST(delegate, holds_and_target)
+{
+    using Del = delegate<int(int)>;
+    MemberCheck mc;
+    auto lambda = [](int x) { return x * 3; };
+    auto const clambda = [](int x) { return x * 4; };
+
+    auto dm = Del::make<MemberCheck, &MemberCheck::member>(mc);
+    EXPECT_TRUE((dm.holds<MemberCheck, &MemberCheck::member>()));
+    EXPECT_FALSE((dm.holds<MemberCheck, &MemberCheck::cmember>()));
+    EXPECT_FALSE(dm.holds<freeFkn>());
+
+    auto dc = Del::make<MemberCheck, &MemberCheck::cmember>(mc);
+    EXPECT_TRUE((dc.holds<MemberCheck, &MemberCheck::cmember>()));
+    EXPECT_FALSE((dc.holds<MemberCheck, &MemberCheck::member>()));
+
+    auto df = Del::make<freeFkn>();
+    EXPECT_TRUE(df.holds<freeFkn>());
+    EXPECT_FALSE(Del{}.holds<freeFkn>());
+    // Runtime function pointers have no specific trampoline.
+    EXPECT_FALSE(Del::make(freeFkn).holds<freeFkn>());
+
+    auto dl = Del::make(lambda);
+    EXPECT_EQ(dl.target<decltype(lambda)>(), &lambda);
+    EXPECT_EQ(dm.target<decltype(lambda)>(), nullptr);
+    auto dcl = Del::make(clambda);
+    EXPECT_EQ(dcl.target<decltype(clambda)>(), &clambda);
+    // Lambdas have a single const call operator and share the trampoline
+    // for F and F const, so both constness are found, as a const pointer.
+    EXPECT_EQ(dl.target<decltype(lambda) const>(), &lambda);
+    using CL = std::remove_const<decltype(clambda)>::type;
+    static_assert(std::is_same<decltype(dcl.target<CL>()), CL const*>::value,
+                  "no mutable access to a functor possibly bound const");
+    EXPECT_EQ(dcl.target<CL>(), &clambda);
+    EXPECT_EQ(dm.target<decltype(lambda) const>(), nullptr);
+
+    int count = 0;
+    auto mlambda = [count](int x) mutable { return count += x; };
+    auto dml = Del::make(mlambda);
+    EXPECT_EQ(dml.target<decltype(mlambda)>(), &mlambda);
+}
+
+TEST(delegate, const_call_functor_share_trampoline)
+{
+    using Del = delegate<int(int)>;
+    auto lambda = [](int x) { return x + 1; };
+    auto const& clambda = lambda;
+
+    // Bound as F and F const, one trampoline instantiation.
+    EXPECT_EQ(Del::make(lambda).trampoline(), Del::make(clambda).trampoline());
+    EXPECT_EQ(Del::make(lambda), Del::make(clambda));
+    Del d;
+    d.set(lambda);
+    EXPECT_EQ(d, Del::make(clambda));
+    EXPECT_EQ(d(2), 3);
+
+    // Functors with overloaded call operators keep separate trampolines.
+    struct Overloaded
+    {
+        int operator()(int x)
+        {
+            return x + 2;
+        }
+        int operator()(int x) const
+        {
+            return x + 3;
+        }
+    };
+    Overloaded o;
+    Overloaded const& co = o;
+    EXPECT_NE(Del::make(o).trampoline(), Del::make(co).trampoline());
+    EXPECT_EQ(Del::make(o)(1), 3);
+    EXPECT_EQ(Del::make(co)(1), 4);
+
+    using test_ns::details::const_call_only;
+    auto mlambda = [](int x) mutable { return x + 2; };
+    EXPECT_TRUE(bool(const_call_only<decltype(lambda)>::value));
+    EXPECT_FALSE(bool(const_call_only<decltype(mlambda)>::value));
+    EXPECT_FALSE(bool(const_call_only<Overloaded>::value));
+    EXPECT_FALSE(bool(const_call_only<int>::value));
+}
+
+TEST(delegate, const_call_functor_equality)
+{
+    using Del = delegate<int(int)>;
+    auto lambda = [](int x) { return x + 1; };
+    auto const& clambda = lambda;
+    auto other = lambda;
+
+    // Same functor object bound as F and F const compare equal.
+    EXPECT_TRUE(Del::make(lambda) == Del::make(clambda));
+    EXPECT_FALSE(Del::make(lambda) != Del::make(clambda));
+    EXPECT_TRUE(Del::equal(Del::make(lambda), Del::make(clambda)));
+    EXPECT_FALSE(Del::less(Del::make(lambda), Del::make(clambda)));
+    EXPECT_FALSE(Del::less(Del::make(clambda), Del::make(lambda)));
+
+    // Another object of the same type is a different target.
+    EXPECT_FALSE(Del::make(lambda) == Del::make(other));
+    EXPECT_EQ(Del::make(lambda).trampoline(), Del::make(other).trampoline());
+}
+
+TEST(delegate, call_with_hint)
+{
+    using Del = delegate<int(int)>;
+    MemberCheck mc;
+
+    auto dm = Del::make<MemberCheck, &MemberCheck::member>(mc);
+    EXPECT_EQ((dm.call_with_hint<MemberCheck, &MemberCheck::member>(1)), 2);
+    // Wrong hint fall back to the indirect call.
+    EXPECT_EQ((dm.call_with_hint<MemberCheck, &MemberCheck::cmember>(1)), 2);
+    EXPECT_EQ(dm.call_with_hint<freeFkn>(1), 2);
+
+    auto dc = Del::make<MemberCheck, &MemberCheck::cmember>(mc);
+    EXPECT_EQ((dc.call_with_hint<MemberCheck, &MemberCheck::cmember>(1)), 3);
+    EXPECT_EQ(Del::make<freeFkn>().call_with_hint<freeFkn>(1), 6);
+    EXPECT_EQ(Del{}.call_with_hint<freeFkn>(1), 0);
+
+#if __cplusplus >= 201703
+    EXPECT_TRUE(dm.holds<&MemberCheck::member>());
+    EXPECT_FALSE(dm.holds<&MemberCheck::cmember>());
+    EXPECT_TRUE(dc.holds<&MemberCheck::cmember>());
+    EXPECT_EQ(dm.call_with_hint<&MemberCheck::member>(1), 2);
+    EXPECT_EQ(dc.call_with_hint<&MemberCheck::cmember>(1), 3);
+    EXPECT_EQ(dc.call_with_hint<&MemberCheck::member>(1), 3);
+#endif
+}
+
+#ifdef DELEGATE_NOEXCEPT_TYPES
+namespace
+{
+int
+freeNoexcept(int x) noexcept
+{
+    return x + 1;
+}
+
+int
+freeNoexceptWithVoid(void* p, int x) noexcept
+{
+    return *static_cast<int*>(p) + x;
+}
+
+struct NoexceptObj
+{
+    int get(int x) noexcept
+    {
+        return m_val + x;
+    }
+    int getc(int x) const noexcept
+    {
+        return m_val * x;
+    }
+    int mayThrow(int x)
+    {
+        return x;
+    }
+    int m_val = 10;
+};
+} // namespace
+
+TEST(delegate, noexcept_signature)
+{
+    using Del = delegate<int(int) noexcept>;
+    static_assert(Del::is_noexcept, "");
+    static_assert(!delegate<int(int)>::is_noexcept, "");
+    static_assert(noexcept(std::declval<Del const&>()(1)), "");
+    static_assert(!noexcept(std::declval<delegate<int(int)> const&>()(1)), "");
+
+    Del del;
+    EXPECT_TRUE(del.null());
+    EXPECT_EQ(del(1), 0);
+
+    del.set<freeNoexcept>();
+    EXPECT_EQ(del(1), 2);
+    EXPECT_TRUE(del == Del::make<freeNoexcept>());
+
+    NoexceptObj o;
+    del = Del::make<NoexceptObj, &NoexceptObj::get>(o);
+    EXPECT_EQ(del(1), 11);
+    del = Del::make<&NoexceptObj::getc>(o);
+    EXPECT_EQ(del(2), 20);
+
+    auto lambda = [](int x) noexcept { return x * 3; };
+    del = Del::make(lambda);
+    EXPECT_EQ(del(2), 6);
+    del = Del{[](int x) noexcept { return x - 3; }};
+    EXPECT_EQ(del(2), -1);
+
+    int ctx = 5;
+    del = Del::make_free_with_void<freeNoexceptWithVoid>(&ctx);
+    EXPECT_EQ(del(1), 6);
+
+    auto mf = mem_fkn<NoexceptObj, false, int(int) noexcept>::make<
+        &NoexceptObj::get>();
+    del.set(mf, o);
+    EXPECT_EQ(del(2), 12);
+
+    EXPECT_EQ(std::hash<Del>{}(del), Del::hash(del));
+
+    // Only noexcept targets accepted.
+    static_assert(!std::is_constructible<Del, int (*)(int)>::value, "");
+    static_assert(std::is_constructible<Del, int (*)(int) noexcept>::value,
+                  "");
+    // Del::make<NoexceptObj, &NoexceptObj::mayThrow>(o); // Does not compile.
+}
+
+TEST(delegate, noexcept_targets_in_plain_signature)
+{
+    using Del = delegate<int(int)>;
+    NoexceptObj o;
+    auto del = Del::make<freeNoexcept>();
+    EXPECT_EQ(del(1), 2);
+    del = Del::make<NoexceptObj, &NoexceptObj::get>(o);
+    EXPECT_EQ(del(1), 11);
+    del = Del::make<&NoexceptObj::getc>(o);
+    EXPECT_EQ(del(2), 20);
+    del = Del::make<&NoexceptObj::mayThrow>(o);
+    EXPECT_EQ(del(2), 2);
+    del = Del{freeNoexcept};
+    EXPECT_EQ(del(2), 3);
+}
+#endif
+
 struct TestObj
 {
     TestObj() = default;
@@ -1081,6 +1509,25 @@ TEST(mem_fkn, value_based_const)
     EXPECT_TRUE(mf2 < mf3 || mf2 > mf3);
 }
 
+TEST(mem_fkn, can_store_in_an_unordered_set)
+{
+    using MemFkn = mem_fkn<MCheck, false, int(int)>;
+    std::unordered_set<MemFkn> testSet;
+    EXPECT_TRUE(testSet.insert(MemFkn{}).second);
+    EXPECT_TRUE(testSet.insert(MemFkn::make<&MCheck::member>()).second);
+    EXPECT_TRUE(
+        testSet.insert(MemFkn::make_from_const<&MCheck::cmember>()).second);
+    EXPECT_FALSE(testSet.insert(MemFkn::make<&MCheck::member>()).second);
+    EXPECT_FALSE(testSet.insert(MemFkn{}).second);
+    EXPECT_EQ(testSet.size(), 3u);
+
+    using CMemFkn = mem_fkn<MCheck, true, int(int)>;
+    std::unordered_set<CMemFkn, CMemFkn::Hash> testSet2;
+    testSet2.insert(CMemFkn::make<&MCheck::cmember>());
+    testSet2.insert(CMemFkn::make<&MCheck::cmember>());
+    EXPECT_EQ(testSet2.size(), 1u);
+}
+
 // See that the set/make for aiding in reworking old C code works.
 // Assume some driver (act as a service) which offer callbacks to be registered.
 // Assume it offers a void* context pointer that will be passed on.
@@ -1250,7 +1697,7 @@ static delegate<int(int)>
 make_exchange(int& store)
 {
     using Del = delegate<int(int)>;
-    typename Del::Trampoline adapterFkn = [](const typename Del::DataPtr& v,
+    typename Del::Trampoline adapterFkn = [](typename Del::DataPtr v,
                                              int val) -> int {
         int* p = static_cast<int*>(v.ptr());
         std::swap(*p, val);
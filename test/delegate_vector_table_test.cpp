@@ -0,0 +1,169 @@
+#include "delegate/delegate_vector_table.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Uart
+{
+    void onIrq()
+    {
+        ++irqs;
+    }
+    int irqs = 0;
+};
+
+int s_timerTicks = 0;
+
+void
+timerIrq()
+{
+    ++s_timerTicks;
+}
+
+struct TestIrq
+{
+};
+using Vectors = delegate_vector_table<4, TestIrq>;
+using Del = Vectors::Delegate;
+
+} // namespace
+
+// Write the slot states 'set' passes through, as seen by an interrupting
+// handler.
+namespace details
+{
+
+template <>
+struct vector_table_access<Vectors>
+{
+    // Staged 'd', slot still holding the old data.
+    template <size_t I>
+    static void stage(Del d)
+    {
+        Vectors::s_staged[I].m_fkn.store(d.trampoline());
+        Vectors::s_staged[I].m_data.store(d.data());
+        Vectors::s_slots[I].m_fkn.store(&Vectors::doStaged<I>);
+    }
+    // Then the new data, slot trampoline still the staged one.
+    template <size_t I>
+    static void stageData(Del d)
+    {
+        Vectors::s_slots[I].m_data.store(d.data());
+    }
+    // Mark a 'set' of vector I as in progress.
+    template <size_t I>
+    static void busy(bool b)
+    {
+        Vectors::s_busy[I].store(b);
+    }
+};
+
+} // namespace details
+
+namespace
+{
+using Access = details::vector_table_access<Vectors>;
+} // namespace
+
+DELEGATE_VECTOR_HANDLER(Vectors, 2, test_uart_irq_handler)
+
+TEST(delegate_vector_table, null_until_set)
+{
+    EXPECT_TRUE(Vectors::get<0>().null());
+    // Interrupts before set are ignored.
+    Vectors::handler<0>();
+    Vectors::handlers().value[3]();
+}
+
+TEST(delegate_vector_table, set_and_dispatch)
+{
+    Uart uart;
+    Vectors::set<2>(Del::make<Uart, &Uart::onIrq>(uart));
+    Vectors::set<1>(Del::make<timerIrq>());
+    EXPECT_TRUE((Vectors::get<2>() == Del::make<Uart, &Uart::onIrq>(uart)));
+
+    s_timerTicks = 0;
+    Vectors::handler<2>();
+    test_uart_irq_handler();
+    Vectors::handler<1>();
+    EXPECT_EQ(uart.irqs, 2);
+    EXPECT_EQ(s_timerTicks, 1);
+
+    Vectors::clear<2>();
+    test_uart_irq_handler();
+    EXPECT_EQ(uart.irqs, 2);
+    Vectors::clear<1>();
+}
+
+TEST(delegate_vector_table, handler_array)
+{
+    constexpr Vectors::handler_array table = Vectors::handlers();
+    static_assert(Vectors::size == 4, "");
+    EXPECT_EQ(table.value[0], &Vectors::handler<0>);
+    EXPECT_EQ(table.value[3], &Vectors::handler<3>);
+
+    Uart uart;
+    Vectors::set<3>(Del::make<Uart, &Uart::onIrq>(uart));
+    table.value[3]();
+    table.value[0]();
+    EXPECT_EQ(uart.irqs, 1);
+    Vectors::clear<3>();
+}
+
+TEST(delegate_vector_table, rebind)
+{
+    Uart a;
+    Uart b;
+    Vectors::set<0>(Del::make<Uart, &Uart::onIrq>(a));
+    Vectors::handler<0>();
+    Vectors::set<0>(Del::make<Uart, &Uart::onIrq>(b));
+    Vectors::handler<0>();
+    Vectors::handler<0>();
+    EXPECT_EQ(a.irqs, 1);
+    EXPECT_EQ(b.irqs, 2);
+    Vectors::clear<0>();
+}
+
+TEST(delegate_vector_table, handler_during_set_calls_staged)
+{
+    Uart a;
+    Uart b;
+    auto const da = Del::make<Uart, &Uart::onIrq>(a);
+    auto const db = Del::make<Uart, &Uart::onIrq>(b);
+    ASSERT_TRUE(Vectors::set<1>(da));
+
+    // Interrupted after staging.
+    Access::stage<1>(db);
+    Vectors::handler<1>();
+    EXPECT_EQ(a.irqs, 0);
+    EXPECT_EQ(b.irqs, 1);
+    EXPECT_TRUE(Vectors::get<1>() == db);
+
+    // Interrupted after writing the data.
+    Access::stageData<1>(db);
+    Vectors::handler<1>();
+    EXPECT_EQ(b.irqs, 2);
+    EXPECT_TRUE(Vectors::get<1>() == db);
+
+    ASSERT_TRUE(Vectors::set<1>(db));
+    Vectors::handler<1>();
+    EXPECT_EQ(a.irqs, 0);
+    EXPECT_EQ(b.irqs, 3);
+    Vectors::clear<1>();
+}
+
+TEST(delegate_vector_table, set_interrupting_set_fails)
+{
+    Uart a;
+    Access::busy<2>(true);
+    EXPECT_FALSE(Vectors::set<2>(Del::make<Uart, &Uart::onIrq>(a)));
+    EXPECT_TRUE(Vectors::get<2>().null());
+    // Other vectors are independent.
+    EXPECT_TRUE(Vectors::set<3>(Del::make<Uart, &Uart::onIrq>(a)));
+    Access::busy<2>(false);
+    EXPECT_TRUE(Vectors::set<2>(Del::make<Uart, &Uart::onIrq>(a)));
+    EXPECT_TRUE(Vectors::clear<2>());
+    EXPECT_TRUE(Vectors::clear<3>());
+}
@@ -0,0 +1,272 @@
+#include "delegate/executor.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Counter
+{
+    void inc()
+    {
+        count.fetch_add(1);
+    }
+    std::atomic<int> count{0};
+};
+
+// Wait until 'c' reach 'n', running tasks on this thread meanwhile.
+void
+waitFor(delegate_executor& ex, Counter const& c, int n)
+{
+    while (c.count.load() < n)
+    {
+        if (!ex.runOne())
+            std::this_thread::yield();
+    }
+}
+
+using Task = delegate_executor::Task;
+
+// Submit 't', running tasks on this thread while the queue is full.
+void
+submitOrRun(delegate_executor& ex, Task const& t)
+{
+    while (!ex.submit(t))
+    {
+        if (!ex.runOne())
+            std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+TEST(chase_lev_deque, owner_lifo_thief_fifo)
+{
+    Counter c[3];
+    details::chase_lev_deque<Task> q{2};
+    Task t;
+    EXPECT_FALSE(q.take(t));
+    EXPECT_FALSE(q.steal(t));
+    EXPECT_TRUE(q.empty());
+
+    EXPECT_TRUE(q.push(Task::make<Counter, &Counter::inc>(c[0])));
+    EXPECT_TRUE(q.push(Task::make<Counter, &Counter::inc>(c[1])));
+    EXPECT_FALSE(q.push(Task::make<Counter, &Counter::inc>(c[2])));
+
+    ASSERT_TRUE(q.steal(t));
+    t();
+    EXPECT_EQ(c[0].count, 1);
+    EXPECT_TRUE(q.push(Task::make<Counter, &Counter::inc>(c[2])));
+    ASSERT_TRUE(q.take(t));
+    t();
+    EXPECT_EQ(c[2].count, 1);
+    ASSERT_TRUE(q.take(t));
+    t();
+    EXPECT_EQ(c[1].count, 1);
+    EXPECT_FALSE(q.take(t));
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(chase_lev_deque, concurrent_steal)
+{
+    constexpr int kTasks = 20000;
+    Counter c;
+    details::chase_lev_deque<Task> q{1024};
+    std::atomic<bool> done{false};
+    std::atomic<int> stolen{0};
+
+    auto thief = [&] {
+        Task t;
+        while (!done.load())
+        {
+            if (q.steal(t))
+            {
+                t();
+                stolen.fetch_add(1);
+            }
+            else
+                std::this_thread::yield();
+        }
+    };
+    std::thread t1{thief};
+    std::thread t2{thief};
+
+    Task t;
+    for (int i = 0; i < kTasks; ++i)
+    {
+        while (!q.push(Task::make<Counter, &Counter::inc>(c)))
+            std::this_thread::yield();
+        if (i % 3 == 0 && q.take(t))
+            t();
+    }
+    while (q.take(t))
+        t();
+    while (!q.empty())
+        std::this_thread::yield();
+    done = true;
+    t1.join();
+    t2.join();
+    EXPECT_EQ(c.count, kTasks);
+}
+
+TEST(delegate_executor, submit)
+{
+    Counter c;
+    delegate_executor ex{2};
+    EXPECT_EQ(ex.size(), 2u);
+    for (int i = 0; i < 1000; ++i)
+        ex.submit(Task::make<Counter, &Counter::inc>(c));
+    ex.submit(Task{});
+    waitFor(ex, c, 1000);
+    EXPECT_EQ(c.count, 1000);
+}
+
+TEST(delegate_executor, submit_batch)
+{
+    Counter c;
+    std::vector<Task> tasks(500, Task::make<Counter, &Counter::inc>(c));
+    delegate_executor ex{3, 1024};
+    EXPECT_EQ(ex.submit(tasks.data(), tasks.size()), tasks.size());
+    EXPECT_EQ(ex.submit(tasks.data(), tasks.size()), tasks.size());
+    waitFor(ex, c, 1000);
+    EXPECT_EQ(c.count, 1000);
+}
+
+namespace
+{
+
+// Task submitting more tasks from within a worker.
+struct Spawner
+{
+    void run()
+    {
+        for (int i = 0; i < 10; ++i)
+            submitOrRun(*ex, Task::make<Counter, &Counter::inc>(*counter));
+        counter->inc();
+    }
+    delegate_executor* ex;
+    Counter* counter;
+};
+
+} // namespace
+
+TEST(delegate_executor, nested_submit_and_destructor_drain)
+{
+    Counter c;
+    {
+        delegate_executor ex{2, 4};
+        Spawner s{&ex, &c};
+        for (int i = 0; i < 100; ++i)
+            submitOrRun(ex, Task::make<Spawner, &Spawner::run>(s));
+        // The destructor runs everything, also tasks from tasks.
+    }
+    EXPECT_EQ(c.count, 1100);
+}
+
+namespace
+{
+
+// Task blocking its worker until opened.
+struct Gate
+{
+    void run()
+    {
+        running = true;
+        while (!open)
+            std::this_thread::yield();
+    }
+    std::atomic<bool> running{false};
+    std::atomic<bool> open{false};
+};
+
+// Record the order tasks run in.
+struct Recorder
+{
+    int order[16] = {};
+    std::atomic<int> next{0};
+};
+
+struct Record
+{
+    void run()
+    {
+        rec->order[rec->next.fetch_add(1)] = id;
+    }
+    Recorder* rec;
+    int id;
+};
+
+} // namespace
+
+TEST(delegate_executor, external_submit_fifo)
+{
+    Recorder rec;
+    Record r[5] = {{&rec, 0}, {&rec, 1}, {&rec, 2}, {&rec, 3}, {&rec, 4}};
+    Gate gate;
+    {
+        delegate_executor ex{1, 8};
+        ASSERT_TRUE(ex.submit(Task::make<Gate, &Gate::run>(gate)));
+        Task const tasks[] = {Task::make<Record, &Record::run>(r[0]),
+                              Task::make<Record, &Record::run>(r[1]),
+                              Task::make<Record, &Record::run>(r[2])};
+        EXPECT_EQ(ex.submit(tasks, 3), 3u);
+        EXPECT_TRUE(ex.submit(Task::make<Record, &Record::run>(r[3])));
+        EXPECT_TRUE(ex.submit(Task::make<Record, &Record::run>(r[4])));
+        gate.open = true;
+    }
+    ASSERT_EQ(rec.next, 5);
+    for (int i = 0; i < 5; ++i)
+        EXPECT_EQ(rec.order[i], i);
+}
+
+TEST(delegate_executor, submit_full)
+{
+    Counter c;
+    Gate gate;
+    {
+        delegate_executor ex{1, 4};
+        ASSERT_TRUE(ex.submit(Task::make<Gate, &Gate::run>(gate)));
+        while (!gate.running)
+            std::this_thread::yield();
+
+        Task const inc = Task::make<Counter, &Counter::inc>(c);
+        for (int i = 0; i < 4; ++i)
+            EXPECT_TRUE(ex.submit(inc));
+        EXPECT_FALSE(ex.submit(inc));
+        Task const tasks[] = {inc, Task{}, inc};
+        EXPECT_EQ(ex.submit(tasks, 3), 0u);
+
+        // Room again once the worker has taken the queued tasks.
+        gate.open = true;
+        waitFor(ex, c, 4);
+        EXPECT_EQ(ex.submit(tasks, 3), 3u);
+    }
+    EXPECT_EQ(c.count, 6);
+}
+
+TEST(delegate_executor, parallel_for)
+{
+    std::vector<int> v(100003, 0);
+    auto body = [&v](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+            v[i] += 1;
+    };
+    delegate_executor ex{4};
+    ex.parallel_for(0, v.size(), 1000,
+                    delegate_executor::RangeTask::make(body));
+    for (std::size_t i = 0; i < v.size(); ++i)
+        ASSERT_EQ(v[i], 1) << i;
+
+    // Fewer indexes than workers, and empty range.
+    ex.parallel_for(5, 7, 1, delegate_executor::RangeTask::make(body));
+    EXPECT_EQ(v[5], 2);
+    EXPECT_EQ(v[6], 2);
+    EXPECT_EQ(v[7], 1);
+    ex.parallel_for(3, 3, 1, delegate_executor::RangeTask::make(body));
+    EXPECT_EQ(v[3], 1);
+}
@@ -0,0 +1,241 @@
+namespace test_ns
+{
+#include "delegate/flat_delegate_set.hpp"
+}
+
+using test_ns::delegate;
+using test_ns::flat_delegate_set;
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Timer
+{
+    void onTick(int x)
+    {
+        sum += x;
+    }
+    void onTickConst(int x) const
+    {
+        constSum += x;
+    }
+    int sum = 0;
+    mutable int constSum = 0;
+};
+
+int s_freeSum = 0;
+
+void
+freeTick(int x)
+{
+    s_freeSum += x;
+}
+
+using Del = delegate<void(int)>;
+using Set = flat_delegate_set<void(int), 8>;
+
+template <typename S>
+bool
+isSorted(S const& s)
+{
+    for (auto i = s.begin(); i != s.end() && i + 1 != s.end(); ++i)
+    {
+        if (!Del::less(*i, *(i + 1)))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(flat_delegate_set, empty)
+{
+    Set s;
+    EXPECT_TRUE(s.empty());
+    EXPECT_EQ(s.size(), 0u);
+    EXPECT_EQ(Set::capacity(), 8u);
+    EXPECT_TRUE(s.begin() == s.end());
+    s.invoke_all(1);
+    EXPECT_FALSE(s.insert(Del{}));
+    EXPECT_FALSE(s.erase(Del::make<freeTick>()));
+}
+
+TEST(flat_delegate_set, insert_sorted_and_unique)
+{
+    Timer t[4];
+    Set s;
+    for (int i = 3; i >= 0; --i)
+        EXPECT_TRUE(s.insert(Del::make<Timer, &Timer::onTick>(t[i])));
+    EXPECT_TRUE(s.insert(Del::make<freeTick>()));
+    EXPECT_TRUE(s.insert(Del::make<Timer, &Timer::onTickConst>(t[0])));
+    EXPECT_EQ(s.size(), 6u);
+    EXPECT_TRUE(isSorted(s));
+
+    // Already stored.
+    EXPECT_FALSE(s.insert(Del::make<Timer, &Timer::onTick>(t[2])));
+    EXPECT_EQ(s.size(), 6u);
+
+    s_freeSum = 0;
+    s.invoke_all(2);
+    for (auto& timer : t)
+        EXPECT_EQ(timer.sum, 2);
+    EXPECT_EQ(t[0].constSum, 2);
+    EXPECT_EQ(s_freeSum, 2);
+}
+
+TEST(flat_delegate_set, adjacent_trampolines)
+{
+    Timer t[3];
+    Set s;
+    s.insert(Del::make<Timer, &Timer::onTick>(t[0]));
+    s.insert(Del::make<Timer, &Timer::onTickConst>(t[1]));
+    s.insert(Del::make<Timer, &Timer::onTick>(t[2]));
+    s.insert(Del::make<Timer, &Timer::onTickConst>(t[0]));
+    s.insert(Del::make<Timer, &Timer::onTick>(t[1]));
+    int changes = 0;
+    for (auto i = s.begin() + 1; i != s.end(); ++i)
+    {
+        if (i->trampoline() != (i - 1)->trampoline())
+            ++changes;
+    }
+    EXPECT_EQ(changes, 1);
+}
+
+TEST(flat_delegate_set, find_and_erase)
+{
+    Timer t[3];
+    Set s;
+    for (auto& timer : t)
+        s.insert(Del::make<Timer, &Timer::onTick>(timer));
+    auto d1 = Del::make<Timer, &Timer::onTick>(t[1]);
+    EXPECT_TRUE(s.contains(d1));
+    ASSERT_TRUE(s.find(d1) != s.end());
+    EXPECT_TRUE(*s.find(d1) == d1);
+    EXPECT_TRUE(s.find(Del::make<freeTick>()) == s.end());
+
+    EXPECT_TRUE(s.erase(d1));
+    EXPECT_FALSE(s.erase(d1));
+    EXPECT_FALSE(s.contains(d1));
+    EXPECT_EQ(s.size(), 2u);
+    EXPECT_TRUE(isSorted(s));
+
+    s.invoke_all(5);
+    EXPECT_EQ(t[0].sum, 5);
+    EXPECT_EQ(t[1].sum, 0);
+    EXPECT_EQ(t[2].sum, 5);
+
+    s.clear();
+    EXPECT_TRUE(s.empty());
+}
+
+TEST(flat_delegate_set, full)
+{
+    Timer t[9];
+    Set s;
+    for (int i = 0; i < 8; ++i)
+        EXPECT_TRUE(s.insert(Del::make<Timer, &Timer::onTick>(t[i])));
+    EXPECT_TRUE(s.full());
+    EXPECT_FALSE(s.insert(Del::make<Timer, &Timer::onTick>(t[8])));
+    EXPECT_FALSE(s.insert(Del::make<Timer, &Timer::onTick>(t[0])));
+}
+
+TEST(flat_delegate_set, bulk_insert)
+{
+    Timer t[4];
+    Set s;
+    s.insert(Del::make<Timer, &Timer::onTick>(t[1]));
+    Del const batch[] = {
+        Del::make<Timer, &Timer::onTick>(t[3]),
+        Del::make<freeTick>(),
+        Del{},
+        Del::make<Timer, &Timer::onTick>(t[1]),
+        Del::make<Timer, &Timer::onTick>(t[0]),
+        Del::make<Timer, &Timer::onTick>(t[3]),
+    };
+    EXPECT_TRUE(s.insert(batch, 6));
+    EXPECT_EQ(s.size(), 4u);
+    EXPECT_TRUE(isSorted(s));
+    EXPECT_TRUE(s.contains(Del::make<freeTick>()));
+    EXPECT_TRUE(s.contains(Del::make<Timer, &Timer::onTick>(t[0])));
+
+    // Only duplicates, fits in any set.
+    EXPECT_TRUE(s.insert(batch, 6));
+    EXPECT_EQ(s.size(), 4u);
+}
+
+TEST(flat_delegate_set, bulk_insert_counts_after_filtering)
+{
+    Timer t[8];
+    Set s;
+    for (int i = 0; i < 4; ++i)
+        s.insert(Del::make<Timer, &Timer::onTick>(t[i]));
+
+    // 12 delegates, of which 4 new: fills the set exactly.
+    Del batch[12];
+    for (int i = 0; i < 12; ++i)
+        batch[i] = Del::make<Timer, &Timer::onTick>(t[(i * 5) % 8]);
+    EXPECT_TRUE(s.insert(batch, 12));
+    EXPECT_EQ(s.size(), 8u);
+    EXPECT_TRUE(isSorted(s));
+
+    // Not room for the new one, nothing stored.
+    Timer extra;
+    Del const more[] = {batch[0], Del::make<Timer, &Timer::onTickConst>(extra),
+                        batch[1]};
+    EXPECT_FALSE(s.insert(more, 3));
+    EXPECT_EQ(s.size(), 8u);
+    EXPECT_TRUE(isSorted(s));
+    EXPECT_FALSE(s.contains(more[1]));
+}
+
+TEST(flat_delegate_set, bulk_insert_merges)
+{
+    Timer t[64];
+    flat_delegate_set<void(int), 64> s;
+    for (int i = 0; i < 64; i += 3)
+        s.insert(Del::make<Timer, &Timer::onTick>(t[i]));
+    ASSERT_EQ(s.size(), 22u);
+
+    // Reverse order, both trampolines, overlapping the stored ones.
+    Del batch[42];
+    for (int i = 0; i < 42; ++i)
+    {
+        int const ix = 63 - i;
+        batch[i] = ix % 2 ? Del::make<Timer, &Timer::onTickConst>(t[ix])
+                          : Del::make<Timer, &Timer::onTick>(t[ix]);
+    }
+    EXPECT_TRUE(s.insert(batch, 42));
+    // 21 new onTick and 21 onTickConst, minus the 7 even multiples of 3
+    // already stored in [22, 63].
+    EXPECT_EQ(s.size(), 22u + 21u + 21u - 7u);
+    EXPECT_TRUE(isSorted(s));
+    for (auto const& d : batch)
+        EXPECT_TRUE(s.contains(d));
+    for (int i = 0; i < 64; i += 3)
+        EXPECT_TRUE(s.contains(Del::make<Timer, &Timer::onTick>(t[i])));
+}
+
+#if __cplusplus >= 201402L
+namespace
+{
+constexpr flat_delegate_set<void(int), 4>
+makeSet()
+{
+    flat_delegate_set<void(int), 4> s;
+    s.insert(Del::make<freeTick>());
+    return s;
+}
+} // namespace
+
+TEST(flat_delegate_set, constexpr_insert)
+{
+    constexpr auto s = makeSet();
+    static_assert(s.size() == 1, "constexpr insert");
+    static_assert(s.contains(Del::make<freeTick>()), "constexpr contains");
+    s_freeSum = 0;
+    s.invoke_all(3);
+    EXPECT_EQ(s_freeSum, 3);
+}
+#endif
@@ -0,0 +1,114 @@
+namespace test_ns
+{
+#include "delegate/fn_delegate.hpp"
+}
+
+using test_ns::delegate;
+using test_ns::fn_delegate;
+
+#include <memory>
+#include <set>
+#include <type_traits>
+#include <unordered_set>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+int
+freeFkn(int x)
+{
+    return x + 5;
+}
+
+int
+freeFkn2(int x)
+{
+    return x * 2;
+}
+
+using FDel = fn_delegate<int(int)>;
+using Del = delegate<int(int)>;
+
+} // namespace
+
+TEST(fn_delegate, is_one_pointer)
+{
+    EXPECT_EQ(sizeof(FDel), sizeof(void*));
+    EXPECT_TRUE(std::is_trivially_copyable<FDel>::value);
+}
+
+TEST(fn_delegate, null_state)
+{
+    FDel del;
+    EXPECT_TRUE(del.null());
+    EXPECT_FALSE(del);
+    EXPECT_TRUE(del == nullptr);
+    EXPECT_TRUE(nullptr == del);
+    EXPECT_EQ(del(1), 0);
+    EXPECT_EQ(del.get(), nullptr);
+
+    FDel del2{static_cast<int (*)(int)>(nullptr)};
+    EXPECT_TRUE(del2 == del);
+
+    fn_delegate<void(int)> vdel;
+    vdel(1);
+}
+
+TEST(fn_delegate, free_functions_and_lambdas)
+{
+    constexpr auto del = FDel::make<freeFkn>();
+    EXPECT_EQ(del(1), 6);
+    EXPECT_TRUE(del != nullptr);
+    EXPECT_EQ(del.get(), &freeFkn);
+
+    FDel del2{freeFkn2};
+    EXPECT_EQ(del2(3), 6);
+    EXPECT_TRUE(del2 != del);
+
+    FDel del3{[](int x) { return x - 1; }};
+    EXPECT_EQ(del3(3), 2);
+
+    del3.set<freeFkn>();
+    EXPECT_TRUE(del3 == del);
+    del3.set(freeFkn2);
+    EXPECT_TRUE(del3 == del2);
+    del3 = nullptr;
+    EXPECT_TRUE(del3.null());
+    del3.set(nullptr);
+    EXPECT_TRUE(del3.null());
+}
+
+TEST(fn_delegate, converts_to_delegate)
+{
+    Del d = FDel::make<freeFkn>();
+    EXPECT_EQ(d(1), 6);
+    EXPECT_TRUE(d == Del{freeFkn});
+
+    Del n = FDel{};
+    EXPECT_TRUE(n.null());
+}
+
+TEST(fn_delegate, move_only_argument)
+{
+    fn_delegate<int(std::unique_ptr<int>)> del{
+        [](std::unique_ptr<int> p) { return *p; }};
+    EXPECT_EQ(del(std::unique_ptr<int>(new int(3))), 3);
+}
+
+TEST(fn_delegate, containers)
+{
+    std::set<FDel, FDel::Less> s;
+    s.insert(FDel{});
+    s.insert(FDel{freeFkn});
+    s.insert(FDel{freeFkn2});
+    s.insert(FDel{freeFkn});
+    EXPECT_EQ(s.size(), 3u);
+    EXPECT_TRUE(s.begin()->null());
+
+    std::unordered_set<FDel, FDel::Hash, FDel::Equal> us;
+    us.insert(FDel{freeFkn});
+    us.insert(FDel{freeFkn});
+    EXPECT_EQ(us.size(), 1u);
+}
@@ -0,0 +1,141 @@
+#include "delegate/inplace_delegate.hpp"
+
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+int
+freeFkn(int x)
+{
+    return x + 5;
+}
+
+using IDel = inplace_delegate<int(int)>;
+
+} // namespace
+
+TEST(inplace_delegate, default_is_null)
+{
+    IDel del;
+    EXPECT_TRUE(del.null());
+    EXPECT_FALSE(del);
+    EXPECT_TRUE(del == nullptr);
+    EXPECT_TRUE(nullptr == del);
+    EXPECT_EQ(del(1), 0);
+
+    IDel del2{nullptr};
+    EXPECT_TRUE(del2 == nullptr);
+}
+
+TEST(inplace_delegate, stores_capturing_lambda_temporary)
+{
+    int base = 10;
+    int* p = &base;
+    IDel del{[p](int x) { return *p + x; }};
+    EXPECT_TRUE(del != nullptr);
+    EXPECT_EQ(del(1), 11);
+    base = 20;
+    EXPECT_EQ(del(1), 21);
+
+    // Captured by value, nothing refers back to the original lambda.
+    auto make = [](int v) { return IDel{[v](int x) { return v * x; }}; };
+    IDel del2 = make(3);
+    EXPECT_EQ(del2(4), 12);
+
+    del2 = IDel::make([](int x) { return x - 1; });
+    EXPECT_EQ(del2(4), 3);
+
+    int two = 2;
+    del2.set([two](int x) { return two + x; });
+    EXPECT_EQ(del2(4), 6);
+
+    del2 = nullptr;
+    EXPECT_FALSE(del2);
+}
+
+TEST(inplace_delegate, free_functions)
+{
+    auto del = IDel::make<freeFkn>();
+    EXPECT_EQ(del(1), 6);
+
+    IDel del2{freeFkn};
+    EXPECT_EQ(del2(1), 6);
+
+    IDel del3{static_cast<int (*)(int)>(nullptr)};
+    EXPECT_TRUE(del3.null());
+
+    del3.set<freeFkn>();
+    EXPECT_EQ(del3(2), 7);
+}
+
+TEST(inplace_delegate, mutable_functor_state_is_owned)
+{
+    int calls = 0;
+    struct Counter
+    {
+        int* calls;
+        int count;
+        int operator()(int x)
+        {
+            ++*calls;
+            return count += x;
+        }
+    };
+    inplace_delegate<int(int), sizeof(Counter), alignof(Counter)> del{
+        Counter{&calls, 0}};
+    EXPECT_EQ(del(1), 1);
+    EXPECT_EQ(del(2), 3);
+
+    // Copies are independent.
+    auto del2 = del;
+    EXPECT_EQ(del2(3), 6);
+    EXPECT_EQ(del(3), 6);
+    EXPECT_EQ(calls, 4);
+}
+
+TEST(inplace_delegate, is_trivially_copyable)
+{
+    EXPECT_TRUE(std::is_trivially_copyable<IDel>::value);
+    EXPECT_EQ(sizeof(IDel), 3 * sizeof(void*));
+
+    struct Big
+    {
+        char c[64];
+        int operator()(int)
+        {
+            return 0;
+        }
+    };
+    EXPECT_FALSE(IDel::can_store<Big>::value);
+    EXPECT_TRUE((inplace_delegate<int(int), 64>::can_store<Big>::value));
+
+    struct NonTrivial
+    {
+        NonTrivial() = default;
+        NonTrivial(NonTrivial const&) {}
+        int operator()(int)
+        {
+            return 0;
+        }
+    };
+    EXPECT_FALSE(IDel::can_store<NonTrivial>::value);
+}
+
+TEST(inplace_delegate, view_as_delegate)
+{
+    int base = 1;
+    IDel idel{[&base](int x) { return base + x; }};
+    delegate<int(int)> del = idel.view();
+    EXPECT_EQ(del(1), 2);
+    base = 5;
+    EXPECT_EQ(del(1), 6);
+
+    IDel null;
+    EXPECT_TRUE(null.view() == nullptr);
+
+    // Must not compile, view of temporary would dangle.
+    // auto d = IDel{[](int x) { return x; }}.view();
+}
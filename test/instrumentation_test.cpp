@@ -0,0 +1,165 @@
+#include "delegate/instrumentation.hpp"
+
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Handler
+{
+    int onValue(int v)
+    {
+        sum += v;
+        return sum;
+    }
+    int sum = 0;
+};
+
+int
+freeFkn(int x)
+{
+    return x + 5;
+}
+
+// Statistics recorded for 'd', zero calls if not recorded.
+template <typename Del>
+delegate_call_stats
+statsFor(Del const& d)
+{
+    delegate_call_stats found{};
+    delegate_stats::global().for_each([&](delegate_call_stats const& st) {
+        if (st.trampoline == reinterpret_cast<std::uintptr_t>(d.trampoline()) &&
+            st.data == delegate_stats::dataWord(d.data()))
+            found = st;
+    });
+    return found;
+}
+
+} // namespace
+
+TEST(instrumentation, bucket_of)
+{
+    EXPECT_EQ(delegate_stats::bucketOf(0), 0u);
+    EXPECT_EQ(delegate_stats::bucketOf(1), 0u);
+    EXPECT_EQ(delegate_stats::bucketOf(2), 1u);
+    EXPECT_EQ(delegate_stats::bucketOf(1023), 9u);
+    EXPECT_EQ(delegate_stats::bucketOf(1024), 10u);
+    EXPECT_EQ(delegate_stats::bucketOf(~std::uint64_t{0}), 31u);
+}
+
+TEST(instrumentation, record_targets)
+{
+    delegate<int(int)> d = delegate<int(int)>::make<freeFkn>();
+    Handler h1, h2;
+    auto m1 = delegate<int(int)>::make<Handler, &Handler::onValue>(h1);
+    auto m2 = delegate<int(int)>::make<Handler, &Handler::onValue>(h2);
+
+    delegate_stats& stats = delegate_stats::global();
+    stats.record(d, 5);
+    stats.record(d, 100);
+    stats.record(m1, 3);
+    EXPECT_EQ(statsFor(d).calls, 2u);
+    EXPECT_EQ(statsFor(d).total_ns, 105u);
+    EXPECT_EQ(statsFor(d).histogram[2], 1u);
+    EXPECT_EQ(statsFor(d).histogram[6], 1u);
+    EXPECT_EQ(statsFor(m1).calls, 1u);
+    EXPECT_EQ(statsFor(m2).calls, 0u);
+
+    std::ostringstream os;
+    stats.dump(os);
+    EXPECT_NE(os.str().find("calls=2"), std::string::npos);
+    EXPECT_NE(os.str().find("dropped=0"), std::string::npos);
+
+    stats.reset();
+    EXPECT_EQ(statsFor(d).calls, 0u);
+}
+
+TEST(instrumentation, concurrent_record)
+{
+    Handler h;
+    auto m = delegate<int(int)>::make<Handler, &Handler::onValue>(h);
+    delegate_stats::global().reset();
+
+    auto work = [&m]() {
+        for (int i = 0; i < 1000; ++i)
+            delegate_stats::global().record(m, 1);
+    };
+    std::thread t1{work};
+    std::thread t2{work};
+    t1.join();
+    t2.join();
+    EXPECT_EQ(statsFor(m).calls, 2000u);
+}
+
+#if DELEGATE_INSTRUMENT
+
+TEST(instrumentation, instrumented_delegate_records_calls)
+{
+    Handler h;
+    instrumented_delegate<int(int)> d =
+        delegate<int(int)>::make<Handler, &Handler::onValue>(h);
+    delegate_stats::global().reset();
+
+    EXPECT_EQ(d(2), 2);
+    EXPECT_EQ(d(3), 5);
+    EXPECT_EQ(statsFor(d).calls, 2u);
+
+    instrumented_delegate<int(int)> d2;
+    d2.set<freeFkn>();
+    EXPECT_EQ(d2(1), 6);
+    EXPECT_EQ(statsFor(d2).calls, 1u);
+    EXPECT_EQ(statsFor(d).calls, 2u);
+}
+
+namespace
+{
+
+// Clears the delegate calling it.
+struct SelfClearing
+{
+    int onValue(int v)
+    {
+        owner->clear();
+        return v;
+    }
+    instrumented_delegate<int(int)>* owner;
+};
+
+} // namespace
+
+TEST(instrumentation, callee_clears_delegate)
+{
+    SelfClearing sc;
+    instrumented_delegate<int(int)> d =
+        delegate<int(int)>::make<SelfClearing, &SelfClearing::onValue>(sc);
+    sc.owner = &d;
+    delegate<int(int)> const target = d;
+    delegate_stats::global().reset();
+
+    EXPECT_EQ(d(4), 4);
+    EXPECT_TRUE(d.null());
+    // Charged to the target called, not to the cleared delegate.
+    EXPECT_EQ(statsFor(target).calls, 1u);
+    EXPECT_EQ(statsFor(d).calls, 0u);
+}
+
+#else
+
+TEST(instrumentation, disabled_is_plain_delegate)
+{
+    static_assert(std::is_same<instrumented_delegate<int(int)>,
+                               delegate<int(int)>>::value,
+                  "Disabled instrumentation should be a plain delegate");
+    Handler h;
+    instrumented_delegate<int(int)> d =
+        delegate<int(int)>::make<Handler, &Handler::onValue>(h);
+    delegate_stats::global().reset();
+    EXPECT_EQ(d(2), 2);
+    EXPECT_EQ(statsFor(d).calls, 0u);
+}
+
+#endif
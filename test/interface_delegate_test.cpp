@@ -0,0 +1,190 @@
+#include "delegate/interface_delegate.hpp"
+
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Buf
+{
+    int len;
+};
+
+struct Conn
+{
+    void onRead(Buf const& b)
+    {
+        m_read += b.len;
+    }
+    void onWrite(Buf const& b)
+    {
+        m_written += b.len;
+    }
+    void onClose()
+    {
+        m_closed = true;
+    }
+    int pending() const
+    {
+        return m_read - m_written;
+    }
+    int m_read = 0;
+    int m_written = 0;
+    bool m_closed = false;
+};
+
+struct Sensor
+{
+    int value() const
+    {
+        return m_value;
+    }
+    int scaled(int k) const
+    {
+        return m_value * k;
+    }
+    int m_value = 7;
+};
+
+using ConnIf =
+    interface_delegate<void(Buf const&), void(Buf const&), void(), int()>;
+using SensorIf = interface_delegate<int(), int(int)>;
+
+} // namespace
+
+TEST(interface_delegate, null_state)
+{
+    ConnIf d;
+    EXPECT_TRUE(d.null());
+    EXPECT_FALSE(d);
+    EXPECT_TRUE(d == nullptr);
+    EXPECT_TRUE(nullptr == d);
+    EXPECT_EQ(d.call<3>(), 0);
+    d.call<0>(Buf{1});
+    d.call<2>();
+    EXPECT_TRUE(d.get<1>().null());
+
+    ConnIf d2{nullptr};
+    EXPECT_TRUE(d2.null());
+    EXPECT_TRUE(d == d2);
+}
+
+TEST(interface_delegate, size_and_copy)
+{
+    EXPECT_EQ(sizeof(ConnIf), 2 * sizeof(void*));
+    EXPECT_EQ(sizeof(interface_delegate<void()>), 2 * sizeof(void*));
+    EXPECT_TRUE(std::is_trivially_copyable<ConnIf>::value);
+    EXPECT_EQ(ConnIf::size, 4u);
+}
+
+TEST(interface_delegate, member_functions)
+{
+    Conn c;
+    auto d = ConnIf::make<&Conn::onRead, &Conn::onWrite, &Conn::onClose,
+                          &Conn::pending>(c);
+    EXPECT_TRUE(d != nullptr);
+    EXPECT_EQ(d.object(), &c);
+    d.call<0>(Buf{5});
+    d.call<1>(Buf{2});
+    EXPECT_EQ(c.m_read, 5);
+    EXPECT_EQ(c.m_written, 2);
+    EXPECT_EQ(d.call<3>(), 3);
+    EXPECT_FALSE(c.m_closed);
+    d.call<2>();
+    EXPECT_TRUE(c.m_closed);
+
+    d.clear();
+    EXPECT_TRUE(d.null());
+}
+
+TEST(interface_delegate, const_member_functions)
+{
+    Sensor const s;
+    auto d = SensorIf::make<&Sensor::value, &Sensor::scaled>(s);
+    EXPECT_EQ(d.call<0>(), 7);
+    EXPECT_EQ(d.call<1>(3), 21);
+
+    Sensor ms;
+    ms.m_value = 2;
+    auto md = SensorIf::make<&Sensor::value, &Sensor::scaled>(ms);
+    EXPECT_EQ(md.call<1>(5), 10);
+}
+
+TEST(interface_delegate, get_same_as_delegate)
+{
+    Conn c;
+    auto d = ConnIf::make<&Conn::onRead, &Conn::onWrite, &Conn::onClose,
+                          &Conn::pending>(c);
+    auto read = d.get<0>();
+    EXPECT_TRUE((std::is_same<decltype(read),
+                              delegate<void(Buf const&)>>::value));
+    EXPECT_TRUE(
+        (read == delegate<void(Buf const&)>::make<&Conn::onRead>(c)));
+    EXPECT_TRUE(
+        (d.get<1>() == delegate<void(Buf const&)>::make<&Conn::onWrite>(
+                           c)));
+    EXPECT_TRUE(read != d.get<1>());
+    read(Buf{4});
+    EXPECT_EQ(c.m_read, 4);
+}
+
+TEST(interface_delegate, equality)
+{
+    Conn c1;
+    Conn c2;
+    auto d1 = ConnIf::make<&Conn::onRead, &Conn::onWrite,
+                           &Conn::onClose, &Conn::pending>(c1);
+    auto d1b = ConnIf::make<&Conn::onRead, &Conn::onWrite,
+                            &Conn::onClose, &Conn::pending>(c1);
+    auto d2 = ConnIf::make<&Conn::onRead, &Conn::onWrite,
+                           &Conn::onClose, &Conn::pending>(c2);
+    // Entries swapped, another table.
+    auto swapped = ConnIf::make<&Conn::onWrite, &Conn::onRead,
+                                &Conn::onClose, &Conn::pending>(c1);
+    EXPECT_TRUE(d1 == d1b);
+    EXPECT_TRUE(d1 != d2);
+    EXPECT_TRUE(d1 != swapped);
+    swapped.call<0>(Buf{3});
+    EXPECT_EQ(c1.m_written, 3);
+}
+
+namespace
+{
+Sensor const g_sensor{};
+constexpr SensorIf k_sensor =
+    SensorIf::make<&Sensor::value, &Sensor::scaled>(g_sensor);
+constexpr SensorIf k_null{};
+} // namespace
+
+TEST(interface_delegate, constexpr_make)
+{
+    EXPECT_TRUE(bool(k_sensor));
+    EXPECT_TRUE(k_null.null());
+    EXPECT_EQ(k_sensor.call<0>(), 7);
+    EXPECT_EQ(k_sensor.call<1>(2), 14);
+}
+
+TEST(interface_delegate, noexcept_signatures)
+{
+    struct Led
+    {
+        void on() noexcept
+        {
+            m_on = true;
+        }
+        bool lit() const noexcept
+        {
+            return m_on;
+        }
+        bool m_on = false;
+    };
+    using LedIf = interface_delegate<void() noexcept, bool() noexcept>;
+    Led led;
+    auto d = LedIf::make<&Led::on, &Led::lit>(led);
+    EXPECT_TRUE(noexcept(d.get<0>()()));
+    EXPECT_FALSE(d.call<1>());
+    d.call<0>();
+    EXPECT_TRUE(d.call<1>());
+}
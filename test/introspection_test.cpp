@@ -0,0 +1,107 @@
+#include "delegate/introspection.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+// Not in an anonymous namespace. Trampolines for targets with internal
+// linkage are not in the dynamic symbol table.
+struct Handler
+{
+    int onValue(int v)
+    {
+        return v + 1;
+    }
+    int peek(int v) const
+    {
+        return v;
+    }
+};
+
+int
+freeFkn(int x)
+{
+    return x + 5;
+}
+
+namespace
+{
+
+// Contents of the file at 'path'.
+std::string
+readFile(std::string const& path)
+{
+    std::ifstream f{path};
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+} // namespace
+
+TEST(introspection, target_type_name)
+{
+    Handler h;
+    auto d = delegate<int(int)>::make<Handler, &Handler::onValue>(h);
+    std::string const name = target_type_name(d);
+    EXPECT_NE(name.find("doMemberCB"), std::string::npos) << name;
+    EXPECT_NE(name.find("Handler::onValue"), std::string::npos) << name;
+    EXPECT_EQ(d.target_object(), &h);
+
+    auto f = delegate<int(int)>::make<freeFkn>();
+    EXPECT_NE(target_type_name(f).find("freeFkn"), std::string::npos)
+        << target_type_name(f);
+
+    auto mf = mem_fkn<Handler, true, int(int)>::make<&Handler::peek>();
+    EXPECT_NE(target_type_name(mf).find("Handler::peek"), std::string::npos)
+        << target_type_name(mf);
+}
+
+TEST(introspection, unknown_address_as_hex)
+{
+    EXPECT_EQ(trampoline_name(0x10), "0x10");
+}
+
+TEST(introspection, perf_map)
+{
+    std::string const path = "introspection_test_perf.map";
+    std::remove(path.c_str());
+
+    Handler h1, h2;
+    auto d1 = delegate<int(int)>::make<Handler, &Handler::onValue>(h1);
+    auto d2 = delegate<int(int)>::make<Handler, &Handler::onValue>(h2);
+    auto f = delegate<int(int)>::make<freeFkn>();
+    {
+        delegate_perf_map map{path};
+        ASSERT_TRUE(map.is_open());
+        EXPECT_TRUE(map.add(d1, "Handler::onValue"));
+        // Same trampoline, only written once.
+        EXPECT_FALSE(map.add(d2));
+        EXPECT_TRUE(map.add(f));
+    }
+    std::string const contents = readFile(path);
+    std::remove(path.c_str());
+
+    std::istringstream lines{contents};
+    std::string line;
+    int n = 0;
+    while (std::getline(lines, line))
+    {
+        unsigned long long start = 0, size = 0;
+        char name[256] = {};
+        ASSERT_EQ(std::sscanf(line.c_str(), "%llx %llx %255[^\n]", &start,
+                              &size, name),
+                  3)
+            << line;
+        EXPECT_NE(start, 0u);
+        EXPECT_NE(size, 0u);
+        ++n;
+    }
+    EXPECT_EQ(n, 2);
+    EXPECT_NE(contents.find(" Handler::onValue\n"), std::string::npos);
+    EXPECT_NE(contents.find("freeFkn"), std::string::npos);
+    EXPECT_EQ(delegate_perf_map::default_path().find("/tmp/perf-"), 0u);
+}
@@ -0,0 +1,154 @@
+namespace test_ns
+{
+#include "delegate/multicast_delegate.hpp"
+}
+
+using test_ns::delegate;
+using test_ns::multicast_delegate;
+
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Listener
+{
+    void onEvent(int x)
+    {
+        sum += x;
+        calls++;
+    }
+    void onEventConst(int x) const
+    {
+        constCalls += x;
+    }
+    int sum = 0;
+    int calls = 0;
+    mutable int constCalls = 0;
+};
+
+int s_freeSum = 0;
+
+void
+freeListener(int x)
+{
+    s_freeSum += x;
+}
+
+using Del = delegate<void(int)>;
+using Multi = multicast_delegate<void(int), 4>;
+
+} // namespace
+
+TEST(multicast_delegate, default_is_empty)
+{
+    Multi m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_FALSE(m.full());
+    EXPECT_EQ(m.size(), 0u);
+    EXPECT_EQ(Multi::capacity(), 4u);
+    EXPECT_EQ(m.begin(), m.end());
+
+    // Calling an empty multicast delegate is fine.
+    m(1);
+}
+
+TEST(multicast_delegate, calls_all_in_order)
+{
+    Listener l1;
+    Listener l2;
+    Listener const cl;
+
+    Multi m;
+    EXPECT_TRUE(m.add(Del::make<Listener, &Listener::onEvent>(l1)));
+    EXPECT_TRUE(m.add(Del::make<Listener, &Listener::onEvent>(l2)));
+    EXPECT_TRUE(m.add(Del::make<Listener, &Listener::onEventConst>(cl)));
+    EXPECT_TRUE(m.add(Del::make<freeListener>()));
+    EXPECT_TRUE(m.full());
+    EXPECT_EQ(m.size(), 4u);
+
+    s_freeSum = 0;
+    m(3);
+    EXPECT_EQ(l1.sum, 3);
+    EXPECT_EQ(l2.sum, 3);
+    EXPECT_EQ(cl.constCalls, 3);
+    EXPECT_EQ(s_freeSum, 3);
+
+    EXPECT_TRUE(m[0] == (Del::make<Listener, &Listener::onEvent>(l1)));
+    EXPECT_TRUE(m[3] == Del::make<freeListener>());
+}
+
+TEST(multicast_delegate, refuse_when_full_or_null)
+{
+    Listener l;
+    multicast_delegate<void(int), 2> m;
+    EXPECT_FALSE(m.add(Del{}));
+    EXPECT_TRUE(m.add(Del::make<freeListener>()));
+    EXPECT_TRUE(m.add(Del::make<Listener, &Listener::onEvent>(l)));
+    EXPECT_FALSE(m.add(Del::make<freeListener>()));
+    EXPECT_EQ(m.size(), 2u);
+}
+
+TEST(multicast_delegate, remove)
+{
+    Listener l1;
+    Listener l2;
+    Listener l3;
+    auto d1 = Del::make<Listener, &Listener::onEvent>(l1);
+    auto d2 = Del::make<Listener, &Listener::onEvent>(l2);
+    auto d3 = Del::make<Listener, &Listener::onEvent>(l3);
+
+    Multi m;
+    m.add(d1);
+    m.add(d2);
+    m.add(d3);
+    EXPECT_TRUE(m.contains(d2));
+
+    // Last is moved into the removed slot.
+    EXPECT_TRUE(m.remove(d1));
+    EXPECT_EQ(m.size(), 2u);
+    EXPECT_FALSE(m.contains(d1));
+    EXPECT_TRUE(m[0] == d3);
+    EXPECT_TRUE(m[1] == d2);
+    EXPECT_FALSE(m.remove(d1));
+
+    m(1);
+    EXPECT_EQ(l1.calls, 0);
+    EXPECT_EQ(l2.calls, 1);
+    EXPECT_EQ(l3.calls, 1);
+
+    EXPECT_TRUE(m.remove_at(1));
+    EXPECT_FALSE(m.remove_at(1));
+    EXPECT_EQ(m.size(), 1u);
+    EXPECT_TRUE(m[0] == d3);
+
+    m.clear();
+    EXPECT_TRUE(m.empty());
+    m(1);
+    EXPECT_EQ(l3.calls, 1);
+}
+
+TEST(multicast_delegate, range_for)
+{
+    Listener l;
+    Multi m;
+    m.add(Del::make<Listener, &Listener::onEvent>(l));
+    m.add(Del::make<Listener, &Listener::onEvent>(l));
+    for (auto& d : m)
+        d(2);
+    EXPECT_EQ(l.sum, 4);
+}
+
+TEST(multicast_delegate, is_trivially_copyable)
+{
+    EXPECT_TRUE(std::is_trivially_copyable<Multi>::value);
+
+    Listener l;
+    Multi m;
+    m.add(Del::make<Listener, &Listener::onEvent>(l));
+    Multi m2 = m;
+    m2(5);
+    EXPECT_EQ(l.sum, 5);
+}
@@ -0,0 +1,143 @@
+#include "delegate/relocatable_delegate.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+struct Conn
+{
+    int onData(int x)
+    {
+        m_sum += x;
+        return m_sum;
+    }
+    int id(int x) const
+    {
+        return m_id * 100 + x;
+    }
+    int m_sum = 0;
+    int m_id = 0;
+};
+
+using RDel = relocatable_delegate<int(int)>;
+
+} // namespace
+
+TEST(relocatable_delegate, is_two_words)
+{
+    EXPECT_EQ(sizeof(RDel), 2 * sizeof(void*));
+    EXPECT_TRUE(std::is_trivially_copyable<RDel>::value);
+}
+
+TEST(relocatable_delegate, null_state)
+{
+    RDel d;
+    EXPECT_TRUE(d.null());
+    EXPECT_FALSE(d);
+    EXPECT_TRUE(d == nullptr);
+    EXPECT_EQ(d(1), 0);
+
+    delegate<int(int)> del = d;
+    EXPECT_TRUE(del.null());
+}
+
+TEST(relocatable_delegate, follows_rebase)
+{
+    Conn slab[4];
+    for (int i = 0; i < 4; ++i)
+        slab[i].m_id = i;
+    delegate_pool_id pool = delegate_pools::add(slab);
+    ASSERT_NE(pool, invalid_delegate_pool);
+
+    auto d = RDel::make<Conn, &Conn::onData>(pool, slab[2]);
+    auto c = RDel::make<Conn, &Conn::id>(pool, slab[3]);
+    EXPECT_EQ(d.pool(), pool);
+    EXPECT_EQ(d.offset(), 2 * sizeof(Conn));
+    EXPECT_EQ(d(5), 5);
+    EXPECT_EQ(slab[2].m_sum, 5);
+    EXPECT_EQ(c(1), 301);
+
+    // Move the whole slab.
+    Conn moved[4];
+    std::memcpy(static_cast<void*>(moved), slab, sizeof slab);
+    delegate_pools::rebase(pool, moved);
+    EXPECT_EQ(d(1), 6);
+    EXPECT_EQ(moved[2].m_sum, 6);
+    EXPECT_EQ(slab[2].m_sum, 5);
+    moved[3].m_id = 7;
+    EXPECT_EQ(c(1), 701);
+
+    // As a plain delegate.
+    delegate<int(int)> del = d;
+    EXPECT_EQ(del(1), 7);
+
+    EXPECT_TRUE((d == RDel::make<Conn, &Conn::onData>(pool, moved[2])));
+    EXPECT_TRUE((d != RDel::make<Conn, &Conn::onData>(pool, moved[1])));
+
+    delegate_pools::remove(pool);
+    EXPECT_EQ(delegate_pools::base(pool), nullptr);
+}
+
+TEST(relocatable_delegate, separate_pools)
+{
+    Conn a[2], b[2];
+    delegate_pool_id pa = delegate_pools::add(a);
+    delegate_pool_id pb = delegate_pools::add(b);
+    EXPECT_NE(pa, pb);
+
+    auto da = RDel::make<Conn, &Conn::onData>(pa, a[1]);
+    auto db = RDel::make<Conn, &Conn::onData>(pb, b[1]);
+    EXPECT_EQ(da.offset(), db.offset());
+    da(1);
+    db(2);
+    EXPECT_EQ(a[1].m_sum, 1);
+    EXPECT_EQ(b[1].m_sum, 2);
+
+    delegate_pools::remove(pa);
+    delegate_pools::remove(pb);
+}
+
+TEST(relocatable_delegate, out_of_range_gives_null)
+{
+    Conn slab[2];
+    delegate_pool_id pool = delegate_pools::add(&slab[1]);
+    ASSERT_NE(pool, invalid_delegate_pool);
+
+    EXPECT_TRUE((RDel::make<Conn, &Conn::onData>(pool, slab[1])));
+    // Below the base, and in a pool not registered.
+    EXPECT_FALSE((RDel::make<Conn, &Conn::onData>(pool, slab[0])));
+    EXPECT_FALSE((RDel::make<Conn, &Conn::onData>(invalid_delegate_pool,
+                                                  slab[1])));
+    delegate_pools::remove(pool);
+    EXPECT_FALSE((RDel::make<Conn, &Conn::onData>(pool, slab[1])));
+}
+
+TEST(relocatable_delegate, handle_boundaries)
+{
+    alignas(8) char buf[16];
+    delegate_pool_id pool = delegate_pools::add(buf);
+    ASSERT_NE(pool, invalid_delegate_pool);
+    auto const base = reinterpret_cast<std::uintptr_t>(buf);
+    auto at = [base](std::uintptr_t offset) {
+        return reinterpret_cast<void const*>(base + offset);
+    };
+
+    // Largest offset fitting, and one beyond.
+    std::uintptr_t const max = delegate_pools::offset_mask;
+    std::uintptr_t const h = delegate_pools::handle(pool, at(max));
+    EXPECT_EQ(delegate_pools::pool_of(h), pool);
+    EXPECT_EQ(delegate_pools::offset_of(h), max);
+    EXPECT_EQ(delegate_pools::handle(pool, at(max + 1)), 0u);
+
+    // Offsets must keep the alignment.
+    EXPECT_NE(delegate_pools::handle(pool, at(8), 8), 0u);
+    EXPECT_EQ(delegate_pools::handle(pool, at(4), 8), 0u);
+    EXPECT_NE(delegate_pools::handle(pool, at(4), 4), 0u);
+
+    delegate_pools::remove(pool);
+}
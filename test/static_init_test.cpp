@@ -0,0 +1,296 @@
+/*
+ * static_init_test.cpp
+ *
+ * Namespace scope delegates initialized with each make function and
+ * constructor. They must all be constant initialized, i.e. land in .data or
+ * .rodata without a dynamic initializer. The build checks that the binary
+ * has no static init functions (cmake/check_static_init.cmake), main checks
+ * the delegates call the right targets.
+ *
+ * No gtest here, since test registration is itself a dynamic initializer.
+ */
+
+#include "delegate/delegate.hpp"
+
+#include <cstdio>
+
+// In C++20 'constinit' also make the compiler reject dynamic initialization.
+#if __cplusplus >= 202002L
+#define STATIC_INIT constinit
+#else
+#define STATIC_INIT
+#endif
+
+namespace
+{
+
+struct Obj
+{
+    int add(int x)
+    {
+        return m_val + x;
+    }
+    int cadd(int x) const
+    {
+        return 2 * m_val + x;
+    }
+    int m_val;
+};
+
+struct Functor
+{
+    int operator()(int x)
+    {
+        return x + 100;
+    }
+    int operator()(int x) const
+    {
+        return x + 200;
+    }
+};
+
+int
+freeFkn(int x)
+{
+    return x + 1;
+}
+int
+withVoid(void* p, int x)
+{
+    return p ? static_cast<Obj*>(p)->m_val + x : -x;
+}
+int
+withConstVoid(void const* p, int x)
+{
+    return static_cast<Obj const*>(p)->m_val - x;
+}
+int
+withObj(Obj& o, int x)
+{
+    return o.m_val * x;
+}
+int
+withConstObj(Obj const& o, int x)
+{
+    return o.m_val * x + 1;
+}
+
+Obj g_obj{10};
+Obj const g_cobj{20};
+Functor g_functor;
+Functor const g_cfunctor{};
+
+using Del = delegate<int(int)>;
+using MemFkn = mem_fkn<Obj, false, int(int)>;
+using ConstMemFkn = mem_fkn<Obj, true, int(int)>;
+
+constexpr MemFkn g_mf = MemFkn::make<&Obj::add>();
+constexpr MemFkn g_mfFromConst = MemFkn::make_from_const<&Obj::cadd>();
+constexpr ConstMemFkn g_cmf = ConstMemFkn::make<&Obj::cadd>();
+
+STATIC_INIT Del d_default;
+STATIC_INIT Del d_nullptr = nullptr;
+STATIC_INIT Del d_fknPtr = freeFkn;
+STATIC_INIT Del d_makeFknPtr = Del::make(freeFkn);
+STATIC_INIT Del d_makeFkn = Del::make_fkn(freeFkn);
+STATIC_INIT Del d_free = Del::make<freeFkn>();
+STATIC_INIT Del d_member = Del::make<Obj, &Obj::add>(g_obj);
+STATIC_INIT Del d_constMember = Del::make<Obj, &Obj::cadd>(g_cobj);
+STATIC_INIT Del d_functor = Del::make(g_functor);
+STATIC_INIT Del d_constFunctor = Del::make(g_cfunctor);
+STATIC_INIT Del d_void = Del::make_free_with_void<withVoid>(&g_obj);
+STATIC_INIT Del d_constVoid = Del::make_free_with_void<withConstVoid>(&g_cobj);
+STATIC_INIT Del d_voidNull = Del::make_free_with_void<withVoid>(nullptr);
+STATIC_INIT Del d_object = Del::make_free_with_object<Obj, withObj>(g_obj);
+STATIC_INIT Del d_constObject =
+    Del::make_free_with_object<Obj, withConstObj>(g_cobj);
+STATIC_INIT Del d_constObjectMutable =
+    Del::make_free_with_object<Obj, withConstObj>(g_obj);
+STATIC_INIT Del d_memFkn = Del::make(g_mf, g_obj);
+STATIC_INIT Del d_memFknFromConst = Del::make(g_mfFromConst, g_obj);
+STATIC_INIT Del d_constMemFkn = Del::make(g_cmf, g_cobj);
+STATIC_INIT Del d_constMemFknMutable = Del::make(g_cmf, g_obj);
+
+// Reassembled from parts, as done by containers.
+constexpr Del k_member = Del::make<Obj, &Obj::add>(g_obj);
+STATIC_INIT Del d_parts{k_member.trampoline(), k_member.data()};
+STATIC_INIT Del d_copy = k_member;
+
+#if __cplusplus >= 201703
+STATIC_INIT Del d_auto = Del::make<&Obj::add>(g_obj);
+STATIC_INIT Del d_autoConst = Del::make<&Obj::cadd>(g_cobj);
+STATIC_INIT Del d_autoConstMutable = Del::make<&Obj::cadd>(g_obj);
+STATIC_INIT Del d_lambda{[](int x) { return x * 7; }};
+#endif
+
+// A const table, placed in .rodata.
+constexpr Del k_table[] = {
+    Del::make<freeFkn>(),
+    Del::make<Obj, &Obj::add>(g_obj),
+    Del::make(g_cfunctor),
+    Del::make_free_with_object<Obj, withObj>(g_obj),
+    Del{},
+};
+
+#if __cplusplus >= 201402L
+// The set functions are usable in constexpr functions building tables.
+constexpr Del
+setMember()
+{
+    Del d;
+    d.set<Obj, &Obj::add>(g_obj);
+    return d;
+}
+constexpr Del
+setConstMember()
+{
+    Del d;
+    d.set<Obj, &Obj::cadd>(g_cobj);
+    return d;
+}
+constexpr Del
+setFree()
+{
+    Del d;
+    d.set<freeFkn>();
+    return d;
+}
+constexpr Del
+setFunctor()
+{
+    Del d;
+    d.set(g_functor);
+    return d;
+}
+constexpr Del
+setFknPtr()
+{
+    Del d;
+    d.set(freeFkn);
+    return d;
+}
+constexpr Del
+setMemFkn()
+{
+    Del d;
+    d.set(g_cmf, g_obj);
+    return d;
+}
+constexpr Del
+setFreeWithVoid()
+{
+    Del d;
+    d.set_free_with_void<withConstVoid>(&g_cobj);
+    return d;
+}
+constexpr Del
+setFreeWithObject()
+{
+    Del d;
+    d.set_free_with_object<Obj, withConstObj>(g_obj);
+    return d;
+}
+constexpr MemFkn
+setMemFknMember()
+{
+    MemFkn mf;
+    mf.set<&Obj::add>();
+    return mf;
+}
+
+STATIC_INIT Del d_setMember = setMember();
+STATIC_INIT Del d_setConstMember = setConstMember();
+STATIC_INIT Del d_setFree = setFree();
+STATIC_INIT Del d_setFunctor = setFunctor();
+STATIC_INIT Del d_setFknPtr = setFknPtr();
+STATIC_INIT Del d_setMemFkn = setMemFkn();
+STATIC_INIT Del d_setFreeWithVoid = setFreeWithVoid();
+STATIC_INIT Del d_setFreeWithObject = setFreeWithObject();
+STATIC_INIT Del d_setMemFknMember = Del::make(setMemFknMember(), g_obj);
+#endif
+
+#if __cplusplus >= 201703
+constexpr Del
+setAuto()
+{
+    Del d;
+    d.set<&Obj::cadd>(g_obj);
+    return d;
+}
+STATIC_INIT Del d_setAuto = setAuto();
+#endif
+
+int s_failures = 0;
+
+void
+check(bool ok, char const* what)
+{
+    if (!ok)
+    {
+        std::printf("FAILED: %s\n", what);
+        ++s_failures;
+    }
+}
+
+#define CHECK_CALL(del, arg, expected)                                         \
+    check((del)(arg) == (expected), #del "(" #arg ") == " #expected)
+
+} // namespace
+
+int
+main()
+{
+    check(d_default.null(), "d_default.null()");
+    check(d_nullptr.null(), "d_nullptr.null()");
+    CHECK_CALL(d_fknPtr, 1, 2);
+    CHECK_CALL(d_makeFknPtr, 2, 3);
+    CHECK_CALL(d_makeFkn, 3, 4);
+    CHECK_CALL(d_free, 4, 5);
+    CHECK_CALL(d_member, 1, 11);
+    CHECK_CALL(d_constMember, 1, 41);
+    CHECK_CALL(d_functor, 1, 101);
+    CHECK_CALL(d_constFunctor, 1, 201);
+    CHECK_CALL(d_void, 1, 11);
+    CHECK_CALL(d_constVoid, 1, 19);
+    CHECK_CALL(d_voidNull, 1, -1);
+    CHECK_CALL(d_object, 2, 20);
+    CHECK_CALL(d_constObject, 2, 41);
+    CHECK_CALL(d_constObjectMutable, 2, 21);
+    CHECK_CALL(d_memFkn, 1, 11);
+    CHECK_CALL(d_memFknFromConst, 1, 21);
+    CHECK_CALL(d_constMemFkn, 1, 41);
+    CHECK_CALL(d_constMemFknMutable, 1, 21);
+    CHECK_CALL(d_parts, 2, 12);
+    CHECK_CALL(d_copy, 3, 13);
+    check(d_parts == d_member, "d_parts == d_member");
+
+#if __cplusplus >= 201703
+    CHECK_CALL(d_auto, 1, 11);
+    CHECK_CALL(d_autoConst, 1, 41);
+    CHECK_CALL(d_autoConstMutable, 1, 21);
+    CHECK_CALL(d_lambda, 2, 14);
+#endif
+
+    CHECK_CALL(k_table[0], 1, 2);
+    CHECK_CALL(k_table[1], 1, 11);
+    CHECK_CALL(k_table[2], 1, 201);
+    CHECK_CALL(k_table[3], 3, 30);
+    check(k_table[4].null(), "k_table[4].null()");
+
+#if __cplusplus >= 201402L
+    CHECK_CALL(d_setMember, 1, 11);
+    CHECK_CALL(d_setConstMember, 1, 41);
+    CHECK_CALL(d_setFree, 1, 2);
+    CHECK_CALL(d_setFunctor, 1, 101);
+    CHECK_CALL(d_setFknPtr, 1, 2);
+    CHECK_CALL(d_setMemFkn, 1, 21);
+    CHECK_CALL(d_setFreeWithVoid, 1, 19);
+    CHECK_CALL(d_setFreeWithObject, 2, 21);
+    CHECK_CALL(d_setMemFknMember, 1, 11);
+#endif
+#if __cplusplus >= 201703
+    CHECK_CALL(d_setAuto, 1, 21);
+#endif
+
+    return s_failures == 0 ? 0 : 1;
+}